@@ -0,0 +1,451 @@
+#include "BulkFileLoader.h"
+#include "VirtualFileSystem.h"
+#include "System.h"
+
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+
+#ifdef OS_UNIX_LIKE
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(OS_UNIX_LIKE) && defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define CORE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+using namespace Core;
+
+namespace {
+
+    const std::size_t MAX_READ = 1 << 30;
+
+#ifdef CORE_IO_URING
+
+    /*
+     * Minimal io_uring submission and completion queue pair driven by raw
+     * system calls
+     */
+    class Ring {
+    public:
+
+        Ring() : descriptor_(-1), ring_(), completionRing_(), entries_(), ringSize_(), completionRingSize_(), entriesSize_(), queued_(), params_() {
+        };
+
+        ~Ring() {
+            close();
+        };
+
+        bool setup(unsigned depth) {
+            std::memset(&params_, 0, sizeof (params_));
+            descriptor_ = static_cast<int> (syscall(__NR_io_uring_setup, depth, &params_));
+            if (descriptor_ < 0) {
+                return false;
+            }
+            ringSize_ = params_.sq_off.array + params_.sq_entries * sizeof (unsigned);
+            completionRingSize_ = params_.cq_off.cqes + params_.cq_entries * sizeof (io_uring_cqe);
+            bool single = params_.features & IORING_FEAT_SINGLE_MMAP;
+            if (single) {
+                ringSize_ = completionRingSize_ = std::max(ringSize_, completionRingSize_);
+            }
+            ring_ = map(ringSize_, IORING_OFF_SQ_RING);
+            completionRing_ = single ? ring_ : map(completionRingSize_, IORING_OFF_CQ_RING);
+            entriesSize_ = params_.sq_entries * sizeof (io_uring_sqe);
+            entries_ = static_cast<io_uring_sqe *> (map(entriesSize_, IORING_OFF_SQES));
+            if (!ring_ || !completionRing_ || !entries_) {
+                close();
+                return false;
+            }
+            return true;
+        };
+
+        void close() {
+            if (entries_) {
+                munmap(entries_, entriesSize_);
+            }
+            if (completionRing_ && completionRing_ != ring_) {
+                munmap(completionRing_, completionRingSize_);
+            }
+            if (ring_) {
+                munmap(ring_, ringSize_);
+            }
+            if (descriptor_ >= 0) {
+                ::close(descriptor_);
+            }
+            descriptor_ = -1;
+            ring_ = completionRing_ = nullptr;
+            entries_ = nullptr;
+        };
+
+        void push(int descriptor, char *buffer, std::size_t length, std::uint64_t offset, std::uint64_t userData) {
+            unsigned *tail = field(ring_, params_.sq_off.tail);
+            unsigned mask = *field(ring_, params_.sq_off.ring_mask);
+            unsigned index = *tail & mask;
+            io_uring_sqe &entry = entries_[index];
+            std::memset(&entry, 0, sizeof (entry));
+            entry.opcode = IORING_OP_READ;
+            entry.fd = descriptor;
+            entry.addr = reinterpret_cast<std::uint64_t> (buffer);
+            entry.len = static_cast<std::uint32_t> (length);
+            entry.off = offset;
+            entry.user_data = userData;
+            field(ring_, params_.sq_off.array)[index] = index;
+            __atomic_store_n(tail, *tail + 1, __ATOMIC_RELEASE);
+            ++queued_;
+        };
+
+        /*
+         * Submits queued reads and waits for at least one completion
+         */
+        bool enter() {
+            while (true) {
+                int result = static_cast<int> (syscall(__NR_io_uring_enter, descriptor_, queued_, 1, IORING_ENTER_GETEVENTS, nullptr, 0));
+                if (result >= 0) {
+                    queued_ -= static_cast<unsigned> (result);
+                    return true;
+                } else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                    return false;
+                }
+            }
+        };
+
+        /*
+         * Waits for a completion without submitting
+         */
+        bool wait() {
+            while (true) {
+                if (syscall(__NR_io_uring_enter, descriptor_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) >= 0) {
+                    return true;
+                } else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                    return false;
+                }
+            }
+        };
+
+        /*
+         * Takes back the reads the kernel has not picked up, which never
+         * complete, and appends their user data
+         */
+        void unqueue(std::vector<std::uint64_t> &userData) {
+            unsigned head = __atomic_load_n(field(ring_, params_.sq_off.head), __ATOMIC_ACQUIRE);
+            unsigned *tail = field(ring_, params_.sq_off.tail);
+            unsigned mask = *field(ring_, params_.sq_off.ring_mask);
+            const unsigned *array = field(ring_, params_.sq_off.array);
+            for (unsigned i = head; i != *tail; ++i) {
+                userData.push_back(entries_[array[i & mask]].user_data);
+            }
+            __atomic_store_n(tail, head, __ATOMIC_RELEASE);
+            queued_ = 0;
+        };
+
+        bool pop(io_uring_cqe &completion) {
+            unsigned *head = field(completionRing_, params_.cq_off.head);
+            unsigned tail = __atomic_load_n(field(completionRing_, params_.cq_off.tail), __ATOMIC_ACQUIRE);
+            if (*head == tail) {
+                return false;
+            }
+            unsigned mask = *field(completionRing_, params_.cq_off.ring_mask);
+            completion = reinterpret_cast<io_uring_cqe *> (static_cast<char *> (completionRing_) + params_.cq_off.cqes)[*head & mask];
+            __atomic_store_n(head, *head + 1, __ATOMIC_RELEASE);
+            return true;
+        };
+
+    private:
+        int descriptor_;
+        void *ring_;
+        void *completionRing_;
+        io_uring_sqe *entries_;
+        std::size_t ringSize_;
+        std::size_t completionRingSize_;
+        std::size_t entriesSize_;
+        unsigned queued_;
+        io_uring_params params_;
+
+        void *map(std::size_t size, off_t offset) {
+            void *result = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, descriptor_, offset);
+            return result == MAP_FAILED ? nullptr : result;
+        };
+
+        static unsigned *field(void *ring, std::uint32_t offset) {
+            return reinterpret_cast<unsigned *> (static_cast<char *> (ring) + offset);
+        };
+
+        Ring(const Ring &) = delete;
+        Ring &operator=(const Ring &) = delete;
+    };
+
+#endif
+
+}
+
+BulkFileLoader::BulkFileLoader(ThreadPool &pool) : pool_(pool), requests_(), mutex_(), finished_(), pending_(), error_() {
+}
+
+void BulkFileLoader::add(const Path &path, Callback callback) {
+    requests_.push_back(Request{path, callback, std::vector<char>{}, 0, -1});
+}
+
+std::size_t BulkFileLoader::size() const {
+    return requests_.size();
+}
+
+bool BulkFileLoader::ringAvailable() {
+#ifdef CORE_IO_URING
+    Ring ring;
+    return ring.setup(1);
+#else
+    return false;
+#endif
+}
+
+void BulkFileLoader::dispatch(ThreadPool::Task task) {
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        ++pending_;
+    }
+    pool_.submit([this, task]() {
+        std::exception_ptr error;
+        try {
+            task();
+        } catch (...) {
+            error = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock{mutex_};
+        if (error && !error_) {
+            error_ = error;
+        }
+        if (--pending_ == 0) {
+            finished_.notify_all();
+        }
+    });
+}
+
+void BulkFileLoader::complete(Request &request, bool success) {
+#ifdef OS_UNIX_LIKE
+    if (request.descriptor >= 0) {
+        ::close(request.descriptor);
+        request.descriptor = -1;
+    }
+#endif
+    if (!success) {
+        request.data.clear();
+    }
+    dispatch([&request, success]() {
+        request.callback(request.path, success, request.data);
+    });
+}
+
+namespace {
+
+    /*
+     * Opens the request's file and sizes its buffer, returns false if the
+     * request needs no reads
+     */
+    template<typename Request> bool prepare(Request &request, bool &success) {
+        FileInput input;
+        if (VirtualFileSystem::global().open(request.path.data(), input)) {
+            request.data.assign(input.data(), input.data() + input.size());
+            success = true;
+            return false;
+        }
+        success = false;
+#ifdef OS_UNIX_LIKE
+        request.descriptor = ::open(request.path.data().c_str(), O_RDONLY | O_CLOEXEC);
+        if (request.descriptor < 0) {
+            return false;
+        }
+        struct stat buffer;
+        if (fstat(request.descriptor, &buffer) != 0) {
+            return false;
+        }
+        request.data.resize(static_cast<std::size_t> (buffer.st_size));
+        request.done = 0;
+        success = true;
+        return !request.data.empty();
+#else
+        return false;
+#endif
+    }
+
+    template<typename Request> bool readRemaining(Request &request) {
+#ifdef OS_UNIX_LIKE
+        while (request.done < request.data.size()) {
+            std::size_t length = std::min(request.data.size() - request.done, MAX_READ);
+            ssize_t result = pread(request.descriptor, request.data.data() + request.done, length, static_cast<off_t> (request.done));
+            if (result < 0 && errno == EINTR) {
+                continue;
+            } else if (result < 0) {
+                return false;
+            } else if (result == 0) {
+                request.data.resize(request.done);
+            } else {
+                request.done += static_cast<std::size_t> (result);
+            }
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+}
+
+void BulkFileLoader::read(Request &request) {
+    dispatch([&request]() {
+        // a request the ring already opened continues where the ring stopped
+        bool success = true;
+        if (request.descriptor >= 0 || prepare(request, success)) {
+            success = readRemaining(request);
+        }
+#ifdef OS_UNIX_LIKE
+        if (request.descriptor >= 0) {
+            ::close(request.descriptor);
+            request.descriptor = -1;
+        }
+#endif
+        if (!success) {
+            request.data.clear();
+        }
+        request.callback(request.path, success, request.data);
+    });
+}
+
+void BulkFileLoader::readAll(std::size_t first) {
+    for (std::size_t i = first; i < requests_.size(); ++i) {
+        read(requests_[i]);
+    }
+}
+
+std::size_t BulkFileLoader::readRing(std::size_t first) {
+#ifdef CORE_IO_URING
+    Ring ring;
+    if (!ring.setup(QUEUE_DEPTH)) {
+        return first;
+    }
+    std::vector<std::size_t> inflight;
+    // reads the ring can not do, finished by the pool once the ring is drained
+    std::vector<std::size_t> handOff;
+    bool draining = false;
+    std::size_t next = first;
+    while ((!draining && next < requests_.size()) || !inflight.empty()) {
+        while (!draining && inflight.size() < QUEUE_DEPTH && next < requests_.size()) {
+            Request &request = requests_[next];
+            bool success;
+            if (prepare(request, success)) {
+                ring.push(request.descriptor, request.data.data(), std::min(request.data.size(), MAX_READ), 0, next);
+                inflight.push_back(next);
+            } else {
+                complete(request, success);
+            }
+            ++next;
+        }
+        if (inflight.empty()) {
+            continue;
+        }
+        if (!ring.enter()) {
+            // the ring stopped working, wait until the kernel no longer
+            // writes to the buffers and let the pool read them again
+            std::vector<std::uint64_t> unqueued;
+            ring.unqueue(unqueued);
+            std::vector<std::size_t> taken;
+            for (std::size_t index : inflight) {
+                if (std::find(unqueued.begin(), unqueued.end(), index) == unqueued.end()) {
+                    taken.push_back(index);
+                }
+            }
+            io_uring_cqe completion;
+            while (!taken.empty()) {
+                while (ring.pop(completion)) {
+                    auto found = std::find(taken.begin(), taken.end(), static_cast<std::size_t> (completion.user_data));
+                    if (found != taken.end()) {
+                        taken.erase(found);
+                    }
+                }
+                if (!taken.empty() && !ring.wait()) {
+                    // completions still reach the mapped queue without entering the kernel
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+            ring.close();
+            for (std::size_t index : inflight) {
+                requests_[index].done = 0;
+            }
+            handOff.insert(handOff.end(), inflight.begin(), inflight.end());
+            break;
+        }
+        io_uring_cqe completion;
+        while (ring.pop(completion)) {
+            std::size_t index = static_cast<std::size_t> (completion.user_data);
+            Request &request = requests_[index];
+            bool finished = true;
+            bool success = true;
+            if (completion.res == -EINTR || completion.res == -EAGAIN) {
+                finished = false;
+            } else if (completion.res == -EINVAL || completion.res == -EOPNOTSUPP) {
+                // plain reads need Linux 5.6, rather than reading the rest here
+                // one file at a time, drain the ring and leave it to the pool
+                finished = false;
+                draining = true;
+            } else if (completion.res < 0) {
+                success = false;
+            } else if (completion.res == 0) {
+                request.data.resize(request.done);
+            } else {
+                request.done += static_cast<std::size_t> (completion.res);
+                finished = request.done >= request.data.size();
+            }
+            if (finished || draining) {
+                inflight.erase(std::find(inflight.begin(), inflight.end(), index));
+            }
+            if (finished) {
+                complete(request, success);
+            } else if (draining) {
+                handOff.push_back(index);
+            } else {
+                ring.push(request.descriptor, request.data.data() + request.done, std::min(request.data.size() - request.done, MAX_READ), request.done, index);
+            }
+        }
+    }
+    for (std::size_t index : handOff) {
+        read(requests_[index]);
+    }
+    return next;
+#else
+    return first;
+#endif
+}
+
+void BulkFileLoader::run() {
+    std::exception_ptr error;
+    try {
+        readAll(readRing(0));
+    } catch (...) {
+        error = std::current_exception();
+    }
+    // the tasks refer to the requests, even a failed run waits for them
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        finished_.wait(lock, [this]() {
+            return pending_ == 0;
+        });
+        if (!error) {
+            error = error_;
+        }
+        error_ = nullptr;
+    }
+    requests_.clear();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
@@ -0,0 +1,93 @@
+/*
+ * File:   BulkFileLoader.h
+ * Author: hans
+ *
+ * Created on October 19, 2026, 7:45 PM
+ */
+
+#ifndef BULKFILELOADER_H
+#define	BULKFILELOADER_H
+
+#include "Path.h"
+#include "ThreadPool.h"
+
+#include <vector>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+namespace Core {
+
+    /*
+     * Reads many whole files at once. On Linux the reads are queued through
+     * io_uring so the kernel sees all of them together; elsewhere, or when the
+     * ring can not be set up, each file is read by a pool task. Files inside
+     * mounted packs are served from the pack.
+     *
+     * Callbacks run on the pool's worker threads and may keep the data by
+     * swapping it out of the vector.
+     */
+    class BulkFileLoader {
+    public:
+        using Callback = std::function<void(const Path &path, bool success, std::vector<char> &data)>;
+
+        static const unsigned QUEUE_DEPTH = 64;
+
+        BulkFileLoader(ThreadPool &pool);
+
+        void add(const Path &path, Callback callback);
+
+        /*
+         * Reads every added file and returns once all callbacks have run,
+         * rethrowing the first exception a callback threw; other tasks of
+         * the pool are neither waited for nor rethrown
+         */
+        void run();
+
+        std::size_t size() const;
+
+        static bool ringAvailable();
+
+    private:
+
+        struct Request {
+            Path path;
+            Callback callback;
+            std::vector<char> data;
+            std::size_t done;
+            int descriptor;
+        };
+
+        ThreadPool &pool_;
+        std::vector<Request> requests_;
+        std::mutex mutex_;
+        std::condition_variable finished_;
+        std::size_t pending_;
+        std::exception_ptr error_;
+
+        /*
+         * Submits a task of this run to the pool
+         */
+        void dispatch(ThreadPool::Task task);
+
+        void complete(Request &request, bool success);
+
+        /*
+         * Reads the request on the pool, continuing from where the ring
+         * left it if its file is already open
+         */
+        void read(Request &request);
+
+        void readAll(std::size_t first);
+
+        std::size_t readRing(std::size_t first);
+
+        BulkFileLoader(const BulkFileLoader &) = delete;
+        BulkFileLoader &operator=(const BulkFileLoader &) = delete;
+    };
+
+}
+
+#endif	/* BULKFILELOADER_H */
+
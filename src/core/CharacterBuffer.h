@@ -121,6 +121,7 @@ namespace Core {
             } else {
                 buffer_ = new Intern[capacity];
                 capacity_ = capacity;
+                return true;
             }
         };
 
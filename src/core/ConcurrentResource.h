@@ -0,0 +1,166 @@
+/*
+ * File:   ConcurrentResource.h
+ * Author: hans
+ *
+ * Created on October 19, 2026, 2:05 PM
+ */
+
+#ifndef CONCURRENTRESOURCE_H
+#define	CONCURRENTRESOURCE_H
+
+#include "Resource.h"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <utility>
+
+namespace Core {
+
+    /*
+     * Read mostly resource bundle. Readers look resources up without locking
+     * in an immutable snapshot; writers copy the snapshot, add to the copy and
+     * publish it with an atomic store.
+     *
+     * Superseded snapshots and replaced resources are kept until reclaim() is
+     * called at a point where no reader still uses a pointer obtained before
+     * the last publish, typically once per frame on the reading thread.
+     */
+    template<typename Key_, typename Resource_, typename ResourcePolicy = BasicResourcePolicy<Key_, Resource_>, typename KeyTraits = ResourceKeyTraits<Key_> > class ConcurrentResourceBundle : private ResourcePolicy {
+    public:
+        using Key = Key_;
+        using Resource = Resource_;
+        using Handle = ResourceHandle;
+
+        template<typename... Args> ConcurrentResourceBundle(Args... args) : ResourcePolicy(args...), current_(new Table{}), writer_(), retiredTables_(), retiredResources_() {
+        };
+
+        const Resource *operator[](Handle handle) const {
+            return snapshot()->at(handle);
+        };
+
+        template<typename LookupKey> const Resource *operator[](const LookupKey &key) const {
+            const Table *table = snapshot();
+            return table->at(resolve(*table, key));
+        };
+
+        template<typename LookupKey> Handle find(const LookupKey &key) const {
+            return snapshot()->find(key);
+        };
+
+        template<typename LookupKey> Handle resolve(const LookupKey &key) const {
+            return resolve(*snapshot(), key);
+        };
+
+        template<typename LookupKey> bool contains(const LookupKey &key) const {
+            return snapshot()->find(key).valid();
+        };
+
+        Key key(Handle handle) const {
+            return snapshot()->key(handle);
+        };
+
+        std::size_t size() const {
+            return snapshot()->size();
+        };
+
+        Handle add(Key key, const Resource *resource) {
+            std::pair<Key, const Resource *> entry{key, resource};
+            Handle handle;
+            publish(&entry, &entry + 1, &handle);
+            return handle;
+        };
+
+        /*
+         * Adds a range of key and resource pairs with a single publish
+         */
+        template<typename Iterator> void add(Iterator begin, Iterator end) {
+            publish(begin, end, nullptr);
+        };
+
+        void reclaim() {
+            std::lock_guard<std::mutex> lock{writer_};
+            for (const Table *table : retiredTables_) {
+                delete table;
+            }
+            retiredTables_.clear();
+            for (const Resource *resource : retiredResources_) {
+                ResourcePolicy::replace(resource);
+            }
+            retiredResources_.clear();
+        };
+
+        /*
+         * Not safe while other threads read the bundle
+         */
+        void unloadAll() {
+            reclaim();
+            std::lock_guard<std::mutex> lock{writer_};
+            const Table *table = current_.exchange(new Table{}, std::memory_order_acq_rel);
+            for (const Resource *resource : table->resources()) {
+                ResourcePolicy::destroy(resource);
+            }
+            delete table;
+        };
+
+        ~ConcurrentResourceBundle() {
+            unloadAll();
+            delete current_.load(std::memory_order_relaxed);
+        };
+
+    private:
+        using Table = ResourceTable<Key_, Resource_, KeyTraits>;
+
+        std::atomic<const Table *> current_;
+        std::mutex writer_;
+        std::vector<const Table *> retiredTables_;
+        std::vector<const Resource *> retiredResources_;
+
+        const Table *snapshot() const {
+            return current_.load(std::memory_order_acquire);
+        };
+
+        template<typename LookupKey> Handle resolve(const Table &table, const LookupKey &key) const {
+            Handle handle = table.find(key);
+            if (handle.valid()) {
+                return handle;
+            } else {
+                throw ResourceNotFoundException<Key>(Key(key));
+            }
+        };
+
+        template<typename Iterator> void publish(Iterator begin, Iterator end, Handle *handle) {
+            std::lock_guard<std::mutex> lock{writer_};
+            const Table *current = current_.load(std::memory_order_relaxed);
+            Table *next = new Table{*current};
+            std::vector<const Resource *> replaced;
+            try {
+                for (Iterator i = begin; i != end; ++i) {
+                    Handle added;
+                    const Resource *old = next->insert(i->first, i->second, added);
+                    if (old) {
+                        replaced.push_back(old);
+                    }
+                    if (handle) {
+                        *handle = added;
+                    }
+                }
+                retiredTables_.reserve(retiredTables_.size() + 1);
+                retiredResources_.reserve(retiredResources_.size() + replaced.size());
+            } catch (...) {
+                delete next;
+                throw;
+            }
+            current_.store(next, std::memory_order_release);
+            retiredTables_.push_back(current);
+            retiredResources_.insert(retiredResources_.end(), replaced.begin(), replaced.end());
+        };
+
+        ConcurrentResourceBundle<Key_, Resource_, ResourcePolicy, KeyTraits> &operator=(const ConcurrentResourceBundle<Key_, Resource_, ResourcePolicy, KeyTraits> &) = delete;
+        ConcurrentResourceBundle(const ConcurrentResourceBundle<Key_, Resource_, ResourcePolicy, KeyTraits> &) = delete;
+    };
+
+}
+
+#endif	/* CONCURRENTRESOURCE_H */
+
@@ -0,0 +1,252 @@
+#include "DirectorySnapshot.h"
+#include "System.h"
+
+#include <thread>
+#include <condition_variable>
+#include <deque>
+#include <algorithm>
+
+#ifdef OS_UNIX_LIKE
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace Core;
+
+namespace {
+
+#ifdef OS_UNIX_LIKE
+
+    void fillStatus(const struct stat &buffer, FileStatus &status) {
+        status.exists = true;
+        status.folder = S_ISDIR(buffer.st_mode);
+        status.size = static_cast<std::uint64_t> (buffer.st_size);
+        status.modified = static_cast<std::int64_t> (buffer.st_mtime);
+        status.modifiedNanoseconds = static_cast<std::int64_t> (buffer.st_mtim.tv_nsec);
+    }
+
+#endif
+
+    bool below(const std::string &path, const std::string &root) {
+        return path.size() > root.size() && path.compare(0, root.size(), root) == 0 && path[root.size()] == Path::SEPARATOR;
+    }
+
+}
+
+DirectorySnapshot::Entry::Entry() : status(), directory(), children() {
+}
+
+DirectorySnapshot &DirectorySnapshot::global() {
+    static DirectorySnapshot snapshot;
+    return snapshot;
+}
+
+DirectorySnapshot::DirectorySnapshot() : entries_(), roots_(), mutex_() {
+}
+
+void DirectorySnapshot::scanFolder(const std::string &path, std::vector<std::pair<std::string, Entry> > &found, std::vector<std::string> &names, std::vector<std::string> &folders) const {
+#ifdef OS_UNIX_LIKE
+    int descriptor = ::open(path.c_str(), O_RDONLY | O_DIRECTORY);
+    if (descriptor == -1) {
+        return;
+    }
+    DIR *handle = fdopendir(descriptor);
+    if (!handle) {
+        ::close(descriptor);
+        return;
+    }
+    struct dirent *child = readdir(handle);
+    while (child != NULL) {
+        if (child->d_name[0] != '.') {
+            Entry entry;
+            struct stat buffer;
+            if (fstatat(descriptor, child->d_name, &buffer, 0) == 0) {
+                fillStatus(buffer, entry.status);
+            }
+            if (child->d_type == DT_UNKNOWN) {
+                entry.directory = fstatat(descriptor, child->d_name, &buffer, AT_SYMLINK_NOFOLLOW) == 0 && S_ISDIR(buffer.st_mode);
+            } else {
+                entry.directory = child->d_type == DT_DIR;
+            }
+            std::string name{child->d_name};
+            std::string childPath;
+            childPath.reserve(path.size() + name.size() + 1);
+            childPath.append(path).push_back(Path::SEPARATOR);
+            childPath.append(name);
+            if (entry.directory) {
+                folders.push_back(childPath);
+            }
+            names.push_back(name);
+            found.emplace_back(childPath, entry);
+        }
+        child = readdir(handle);
+    }
+    closedir(handle);
+#endif
+}
+
+void DirectorySnapshot::scan(const Path &root, unsigned threadCount) {
+    std::string rootPath{root.data()};
+    Entry rootEntry;
+    rootEntry.status = root.status();
+    rootEntry.directory = rootEntry.status.folder;
+    invalidate(root);
+    if (!rootEntry.directory) {
+        std::lock_guard<std::mutex> lock{mutex_};
+        entries_[rootPath] = rootEntry;
+        roots_.push_back(rootPath);
+        return;
+    }
+    if (threadCount == 0) {
+        threadCount = std::max(1U, std::thread::hardware_concurrency());
+    }
+    std::deque<std::string> pending{rootPath};
+    std::vector<std::pair<std::string, Entry> > found;
+    std::vector<std::pair<std::string, std::vector<std::string> > > listings;
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    unsigned active = 0;
+    auto work = [&]() {
+        std::unique_lock<std::mutex> lock{queueMutex};
+        while (true) {
+            queueReady.wait(lock, [&]() {
+                return !pending.empty() || active == 0;
+            });
+            if (pending.empty()) {
+                return;
+            }
+            std::string path{pending.front()};
+            pending.pop_front();
+            ++active;
+            lock.unlock();
+            std::vector<std::pair<std::string, Entry> > entries;
+            std::vector<std::string> names;
+            std::vector<std::string> folders;
+            scanFolder(path, entries, names, folders);
+            lock.lock();
+            --active;
+            pending.insert(pending.end(), folders.begin(), folders.end());
+            std::move(entries.begin(), entries.end(), std::back_inserter(found));
+            listings.emplace_back(std::move(path), std::move(names));
+            queueReady.notify_all();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threadCount; ++i) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    std::lock_guard<std::mutex> lock{mutex_};
+    entries_.reserve(entries_.size() + found.size() + 1);
+    entries_[rootPath] = rootEntry;
+    roots_.push_back(rootPath);
+    for (auto &entry : found) {
+        Entry &target = entries_[entry.first];
+        target.status = entry.second.status;
+        target.directory = entry.second.directory;
+    }
+    for (auto &listing : listings) {
+        entries_[listing.first].children.swap(listing.second);
+    }
+}
+
+void DirectorySnapshot::erase(const std::string &path) {
+    std::vector<std::string> pending{path};
+    while (!pending.empty()) {
+        std::string current{std::move(pending.back())};
+        pending.pop_back();
+        auto found = entries_.find(current);
+        if (found != entries_.end()) {
+            for (const std::string &name : found->second.children) {
+                pending.push_back(current + Path::SEPARATOR + name);
+            }
+            entries_.erase(found);
+        }
+    }
+}
+
+void DirectorySnapshot::invalidate(const Path &path) {
+    std::string target{path.data()};
+    std::lock_guard<std::mutex> lock{mutex_};
+    erase(target);
+    // trees scanned below a path that is not in the snapshot itself
+    for (auto i = roots_.begin(); i != roots_.end();) {
+        if (*i == target || below(*i, target)) {
+            erase(*i);
+            i = roots_.erase(i);
+        } else {
+            ++i;
+        }
+    }
+}
+
+void DirectorySnapshot::clear() {
+    std::lock_guard<std::mutex> lock{mutex_};
+    entries_.clear();
+    roots_.clear();
+}
+
+const DirectorySnapshot::Entry *DirectorySnapshot::find(const std::string &path, bool &known) const {
+    auto found = entries_.find(path);
+    if (found != entries_.end()) {
+        known = true;
+        return &found->second;
+    }
+    std::string::size_type separator = path.find_last_of(Path::SEPARATOR);
+    known = false;
+    if (separator != std::string::npos && path.compare(separator + 1, 1, ".") != 0) {
+        auto parent = entries_.find(path.substr(0, separator));
+        if (parent != entries_.end() && parent->second.directory) {
+            const std::vector<std::string> &children = parent->second.children;
+            known = std::find(children.begin(), children.end(), path.substr(separator + 1)) == children.end();
+        }
+    }
+    return nullptr;
+}
+
+bool DirectorySnapshot::status(const std::string &path, FileStatus &status) const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    bool known;
+    const Entry *entry = find(path, known);
+    if (known) {
+        status = entry ? entry->status : FileStatus{};
+    }
+    return known;
+}
+
+bool DirectorySnapshot::children(const std::string &path, bool foldersOnly, std::list<Path> &children) const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    bool known;
+    const Entry *entry = find(path, known);
+    if (!known || (entry && entry->status.folder && !entry->directory)) {
+        return false;
+    }
+    children.clear();
+    if (entry && entry->directory) {
+        Path parent{path};
+        for (const std::string &name : entry->children) {
+            if (!foldersOnly) {
+                children.push_back(Path{parent, name});
+            } else {
+                bool childKnown;
+                const Entry *child = find(parent.child(name).data(), childKnown);
+                if (child && child->directory) {
+                    children.push_back(Path{parent, name});
+                }
+            }
+        }
+    }
+    return true;
+}
+
+std::size_t DirectorySnapshot::size() const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return entries_.size();
+}
+
@@ -0,0 +1,82 @@
+/*
+ * File:   DirectorySnapshot.h
+ * Author: hans
+ *
+ * Created on October 19, 2026, 4:30 PM
+ */
+
+#ifndef DIRECTORYSNAPSHOT_H
+#define	DIRECTORYSNAPSHOT_H
+
+#include "Path.h"
+
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+
+namespace Core {
+
+    /*
+     * In memory copy of directory trees and the status of their entries.
+     * Path answers existence, status and listing queries from the global
+     * snapshot for every path inside a scanned tree; changes made to such a
+     * tree behind the snapshot's back need an explicit invalidate(). Hidden
+     * entries, whose names start with a dot, are not listed and are left to
+     * the file system.
+     */
+    class DirectorySnapshot {
+    public:
+        static DirectorySnapshot &global();
+
+        DirectorySnapshot();
+
+        /*
+         * Walks the tree below root, with threadCount threads or one per
+         * hardware thread for 0
+         */
+        void scan(const Path &root, unsigned threadCount = 1);
+
+        /*
+         * Forgets the path and everything below it, walking only that subtree
+         */
+        void invalidate(const Path &path);
+
+        void clear();
+
+        bool status(const std::string &path, FileStatus &status) const;
+
+        bool children(const std::string &path, bool foldersOnly, std::list<Path> &children) const;
+
+        std::size_t size() const;
+
+    private:
+
+        struct Entry {
+            FileStatus status;
+            bool directory;
+            std::vector<std::string> children;
+
+            Entry();
+        };
+
+        std::unordered_map<std::string, Entry> entries_;
+        // trees scanned, the only entries not listed by their parent
+        std::vector<std::string> roots_;
+        mutable std::mutex mutex_;
+
+        const Entry *find(const std::string &path, bool &known) const;
+
+        void erase(const std::string &path);
+
+        void scanFolder(const std::string &path, std::vector<std::pair<std::string, Entry> > &found, std::vector<std::string> &names, std::vector<std::string> &folders) const;
+
+        DirectorySnapshot(const DirectorySnapshot &) = delete;
+        DirectorySnapshot &operator=(const DirectorySnapshot &) = delete;
+    };
+
+}
+
+#endif	/* DIRECTORYSNAPSHOT_H */
+
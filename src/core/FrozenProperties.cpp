@@ -0,0 +1,286 @@
+#include "FrozenProperties.h"
+#include "Hash.h"
+#include "String.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+using namespace Core;
+
+namespace {
+
+    const char MAGIC[4] = {'S', 'P', 'F', 'M'};
+
+    const std::uint32_t VERSION = 1;
+
+    const std::uint32_t DIRECT_SLOT = 0x80000000U;
+
+    const std::uint32_t MAX_SEED = 0x7FFFFFFFU;
+
+    const std::uint32_t KEYS_PER_BUCKET = 4;
+
+    std::uint32_t bucketOf(std::uint64_t hash, std::uint32_t bucketCount) {
+        return static_cast<std::uint32_t> ((hash >> 32) % bucketCount);
+    }
+
+    std::uint32_t slotOf(std::uint64_t hash, std::uint32_t seed, std::uint32_t count) {
+        if (seed & DIRECT_SLOT) {
+            return seed & ~DIRECT_SLOT;
+        } else {
+            return static_cast<std::uint32_t> (mixHash(hash, seed) % count);
+        }
+    }
+
+    template<typename T> void append(std::vector<char> &image, const T *data, std::size_t count) {
+        const char *begin = reinterpret_cast<const char *> (data);
+        image.insert(image.end(), begin, begin + sizeof (T) * count);
+    }
+
+}
+
+FrozenPropertyMap::FrozenPropertyMap() : image_(), file_(), header_(), seeds_(), slots_(), entries_(), pool_(), values_(), filled_() {
+}
+
+void FrozenPropertyMap::clear() {
+    values_.clear();
+    filled_.reset();
+    header_ = nullptr;
+    seeds_ = nullptr;
+    slots_ = nullptr;
+    entries_ = nullptr;
+    pool_ = nullptr;
+    image_.clear();
+    file_.close();
+}
+
+void FrozenPropertyMap::build(const std::map<std::string, Value> &properties) {
+    std::size_t poolSize = 0;
+    for (auto &property : properties) {
+        poolSize += property.first.length() + property.second.get().length();
+    }
+    if (properties.size() >= DIRECT_SLOT || poolSize > std::numeric_limits<std::uint32_t>::max()) {
+        throw PropertyException("too many properties to freeze");
+    }
+    std::uint32_t count = static_cast<std::uint32_t> (properties.size());
+    std::uint32_t bucketCount = count / KEYS_PER_BUCKET + 1;
+
+    std::vector<Entry> entries;
+    std::vector<char> pool;
+    std::vector<std::string> values;
+    entries.reserve(count);
+    pool.reserve(poolSize);
+    values.reserve(count);
+    for (auto &property : properties) {
+        Entry entry;
+        entry.keyOffset = static_cast<std::uint32_t> (pool.size());
+        entry.keyLength = static_cast<std::uint32_t> (property.first.length());
+        pool.insert(pool.end(), property.first.begin(), property.first.end());
+        entries.push_back(entry);
+        values.push_back(property.second.get());
+    }
+    for (std::uint32_t i = 0; i < count; ++i) {
+        entries[i].valueOffset = static_cast<std::uint32_t> (pool.size());
+        entries[i].valueLength = static_cast<std::uint32_t> (values[i].length());
+        pool.insert(pool.end(), values[i].begin(), values[i].end());
+    }
+
+    std::vector<std::uint64_t> hashes;
+    std::vector<std::vector<std::uint32_t> > buckets{bucketCount};
+    hashes.reserve(count);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        hashes.push_back(hash(pool.data() + entries[i].keyOffset, entries[i].keyLength));
+        buckets[bucketOf(hashes.back(), bucketCount)].push_back(i);
+    }
+    std::vector<std::uint32_t> order;
+    for (std::uint32_t i = 0; i < bucketCount; ++i) {
+        order.push_back(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    const std::uint32_t EMPTY = std::numeric_limits<std::uint32_t>::max();
+    std::vector<std::uint32_t> seeds(bucketCount, 0);
+    std::vector<std::uint32_t> slots(count, EMPTY);
+    std::vector<std::uint32_t> candidate;
+    std::uint32_t freeSlot = 0;
+    for (std::uint32_t b : order) {
+        const std::vector<std::uint32_t> &bucket = buckets[b];
+        if (bucket.empty()) {
+            break;
+        } else if (bucket.size() == 1) {
+            while (slots[freeSlot] != EMPTY) {
+                ++freeSlot;
+            }
+            slots[freeSlot] = bucket.front();
+            seeds[b] = freeSlot | DIRECT_SLOT;
+        } else {
+            std::uint32_t seed = 0;
+            bool placed = false;
+            while (!placed) {
+                if (seed == MAX_SEED) {
+                    throw PropertyException("unable to build a perfect hash for the property keys");
+                }
+                candidate.clear();
+                placed = true;
+                for (std::uint32_t entry : bucket) {
+                    std::uint32_t slot = slotOf(hashes[entry], seed, count);
+                    if (slots[slot] != EMPTY || std::find(candidate.begin(), candidate.end(), slot) != candidate.end()) {
+                        placed = false;
+                        break;
+                    }
+                    candidate.push_back(slot);
+                }
+                if (!placed) {
+                    ++seed;
+                }
+            }
+            for (std::size_t i = 0; i < bucket.size(); ++i) {
+                slots[candidate[i]] = bucket[i];
+            }
+            seeds[b] = seed;
+        }
+    }
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof (MAGIC));
+    header.version = VERSION;
+    header.count = count;
+    header.bucketCount = bucketCount;
+    header.poolSize = static_cast<std::uint32_t> (pool.size());
+
+    std::vector<char> image;
+    image.reserve(sizeof (Header) + sizeof (std::uint32_t) * (bucketCount + count) + sizeof (Entry) * count + pool.size());
+    append(image, &header, 1);
+    append(image, seeds.data(), seeds.size());
+    append(image, slots.data(), slots.size());
+    append(image, entries.data(), entries.size());
+    append(image, pool.data(), pool.size());
+
+    clear();
+    image_.swap(image);
+    attach(image_.data(), image_.size());
+}
+
+void FrozenPropertyMap::write(std::ostream &output) const {
+    if (!header_) {
+        throw PropertyException("unable to write an empty frozen property map");
+    }
+    const char *begin = reinterpret_cast<const char *> (header_);
+    std::size_t length = static_cast<std::size_t> ((pool_ + header_->poolSize) - begin);
+    output.write(begin, static_cast<std::streamsize> (length));
+    if (!output.good()) {
+        throw PropertyException("unable to write frozen property map");
+    }
+}
+
+void FrozenPropertyMap::load(const Path &path) {
+    clear();
+    if (!file_.open(path)) {
+        throw PropertyException{toString("unable to open frozen property map '", path.data(), "'")};
+    }
+    try {
+        attach(file_.data(), file_.size());
+    } catch (PropertyException &e) {
+        clear();
+        throw;
+    }
+}
+
+void FrozenPropertyMap::attach(const char *data, std::size_t length) {
+    if (length < sizeof (Header)) {
+        throw PropertyException("invalid frozen property map: truncated header");
+    }
+    const Header *header = reinterpret_cast<const Header *> (data);
+    if (std::memcmp(header->magic, MAGIC, sizeof (MAGIC)) != 0 || header->version != VERSION) {
+        throw PropertyException("invalid frozen property map: unknown format");
+    }
+    std::size_t expected = sizeof (Header) + sizeof (std::uint32_t) * (static_cast<std::size_t> (header->bucketCount) + header->count) + sizeof (Entry) * header->count + header->poolSize;
+    if (length != expected || header->bucketCount == 0) {
+        throw PropertyException("invalid frozen property map: size mismatch");
+    }
+    header_ = header;
+    seeds_ = reinterpret_cast<const std::uint32_t *> (data + sizeof (Header));
+    slots_ = seeds_ + header->bucketCount;
+    entries_ = reinterpret_cast<const Entry *> (slots_ + header->count);
+    pool_ = reinterpret_cast<const char *> (entries_ + header->count);
+    for (std::uint32_t i = 0; i < header->count; ++i) {
+        const Entry &entry = entries_[i];
+        if (static_cast<std::size_t> (entry.keyOffset) + entry.keyLength > header->poolSize || static_cast<std::size_t> (entry.valueOffset) + entry.valueLength > header->poolSize) {
+            throw PropertyException("invalid frozen property map: entry out of range");
+        }
+    }
+    // empty values own no memory until they are filled
+    values_.resize(header->count);
+    filled_.reset(new std::once_flag[header->count]);
+}
+
+std::size_t FrozenPropertyMap::slot(const char *key, std::size_t length) const {
+    std::uint64_t h = hash(key, length);
+    return slotOf(h, seeds_[bucketOf(h, header_->bucketCount)], header_->count);
+}
+
+std::size_t FrozenPropertyMap::index(const char *key, std::size_t length) const {
+    if (!header_ || header_->count == 0) {
+        return size();
+    }
+    std::uint32_t index = slots_[slot(key, length)];
+    const Entry &entry = entries_[index];
+    if (entry.keyLength == length && std::memcmp(pool_ + entry.keyOffset, key, length) == 0) {
+        return index;
+    } else {
+        return size();
+    }
+}
+
+const FrozenPropertyMap::Value *FrozenPropertyMap::find(const char *key, std::size_t length) const {
+    std::size_t index = this->index(key, length);
+    if (index == size()) {
+        return nullptr;
+    }
+    std::call_once(filled_[index], [this, index]() {
+        Slice text = value(index);
+        values_[index] = Value{std::string{text.begin(), text.end()}};
+    });
+    return &values_[index];
+}
+
+const FrozenPropertyMap::Value *FrozenPropertyMap::find(const std::string &key) const {
+    return find(key.data(), key.length());
+}
+
+const FrozenPropertyMap::Value &FrozenPropertyMap::operator[](const std::string &key) const {
+    const Value *value = find(key);
+    if (value) {
+        return *value;
+    } else {
+        throw PropertyNotFoundException{toString("property '", key, "' not found")};
+    }
+}
+
+FrozenPropertyMap::Slice FrozenPropertyMap::text(const std::string &key) const {
+    std::size_t index = this->index(key.data(), key.length());
+    if (index == size()) {
+        throw PropertyNotFoundException{toString("property '", key, "' not found")};
+    }
+    return value(index);
+}
+
+bool FrozenPropertyMap::contains(const std::string &key) const {
+    return index(key.data(), key.length()) != size();
+}
+
+std::size_t FrozenPropertyMap::size() const {
+    return header_ ? header_->count : 0;
+}
+
+FrozenPropertyMap::Slice FrozenPropertyMap::key(std::size_t index) const {
+    const Entry &entry = entries_[index];
+    return Slice{pool_ + entry.keyOffset, pool_ + entry.keyOffset + entry.keyLength};
+}
+
+FrozenPropertyMap::Slice FrozenPropertyMap::value(std::size_t index) const {
+    const Entry &entry = entries_[index];
+    return Slice{pool_ + entry.valueOffset, pool_ + entry.valueOffset + entry.valueLength};
+}
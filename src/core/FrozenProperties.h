@@ -0,0 +1,121 @@
+/*
+ * File:   FrozenProperties.h
+ * Author: hans
+ *
+ * Created on October 19, 2026, 10:31 AM
+ */
+
+#ifndef FROZENPROPERTIES_H
+#define	FROZENPROPERTIES_H
+
+#include "Properties.h"
+#include "MappedFile.h"
+#include "Path.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <iostream>
+
+namespace Core {
+
+    /*
+     * Read only property map built once after loading.
+     *
+     * Keys are stored sorted in one contiguous pool followed by the values; a
+     * minimal perfect hash (hash and displace) maps every key to its entry, so
+     * a lookup costs one hash and one key compare. The in memory image is the
+     * file format, so a written map can be mapped back without parsing.
+     *
+     * Values stay in the pool: text() returns a view of it, find() converts a
+     * value into its slot of a flat PropertyValue array the first time it is
+     * looked up.
+     */
+    class FrozenPropertyMap {
+    public:
+        using Value = PropertyValue<char>;
+        using Slice = Range<const char *>;
+
+        FrozenPropertyMap();
+
+        void build(const std::map<std::string, Value> &properties);
+
+        void write(std::ostream &output) const;
+
+        void load(const Path &path);
+
+        void clear();
+
+        /*
+         * Null if the key is missing; safe for concurrent lookups without
+         * locking, the value's own conversion cache is not, see
+         * PropertyValue::as()
+         */
+        const Value *find(const char *key, std::size_t length) const;
+
+        const Value *find(const std::string &key) const;
+
+        const Value &operator[](const std::string &key) const;
+
+        /*
+         * Raw value in the pool, throws if the key is missing
+         */
+        Slice text(const std::string &key) const;
+
+        bool contains(const std::string &key) const;
+
+        std::size_t size() const;
+
+        Slice key(std::size_t index) const;
+
+        Slice value(std::size_t index) const;
+
+    private:
+
+        struct Header {
+            char magic[4];
+            std::uint32_t version;
+            std::uint32_t count;
+            std::uint32_t bucketCount;
+            std::uint32_t poolSize;
+        };
+
+        struct Entry {
+            std::uint32_t keyOffset;
+            std::uint32_t keyLength;
+            std::uint32_t valueOffset;
+            std::uint32_t valueLength;
+        };
+
+        std::vector<char> image_;
+        MappedFile file_;
+
+        const Header *header_;
+        const std::uint32_t *seeds_;
+        const std::uint32_t *slots_;
+        const Entry *entries_;
+        const char *pool_;
+        // by entry, each filled from the pool on its first lookup
+        mutable std::vector<Value> values_;
+        mutable std::unique_ptr<std::once_flag[]> filled_;
+
+        void attach(const char *data, std::size_t length);
+
+        std::size_t slot(const char *key, std::size_t length) const;
+
+        /*
+         * Entry of the key or size()
+         */
+        std::size_t index(const char *key, std::size_t length) const;
+
+        FrozenPropertyMap(const FrozenPropertyMap &) = delete;
+        FrozenPropertyMap &operator=(const FrozenPropertyMap &) = delete;
+    };
+
+}
+
+#endif	/* FROZENPROPERTIES_H */
+
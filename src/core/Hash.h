@@ -0,0 +1,45 @@
+/*
+ * File:   Hash.h
+ * Author: hans
+ *
+ * Created on October 19, 2026, 10:12 AM
+ */
+
+#ifndef HASH_H
+#define	HASH_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <type_traits>
+
+namespace Core {
+
+    /*
+     * 64 bit FNV-1a, stable across runs and platforms so hashes can be stored in files
+     */
+    template<typename Char> std::uint64_t hash(const Char *data, std::size_t length) {
+        std::uint64_t result = 0xcbf29ce484222325ULL;
+        for (std::size_t i = 0; i < length; ++i) {
+            result ^= static_cast<std::uint64_t> (static_cast<typename std::make_unsigned<Char>::type> (data[i]));
+            result *= 0x100000001b3ULL;
+        }
+        return result;
+    };
+
+    template<typename Char, typename CharTraits> std::uint64_t hash(const std::basic_string<Char, CharTraits> &data) {
+        return hash(data.data(), data.length());
+    };
+
+    inline std::uint64_t mixHash(std::uint64_t hash, std::uint64_t seed) {
+        hash ^= seed * 0x9e3779b97f4a7c15ULL;
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        return hash;
+    };
+
+}
+
+#endif	/* HASH_H */
+
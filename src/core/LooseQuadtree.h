@@ -0,0 +1,239 @@
+/*
+ * File:   LooseQuadtree.h
+ * Author: hans
+ *
+ * Created on October 20, 2026, 2:10 PM
+ */
+
+#ifndef LOOSEQUADTREE_H
+#define	LOOSEQUADTREE_H
+
+#include "Metrics.h"
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <cmath>
+
+namespace Core {
+
+    /*
+     * Quadtree of bounded values in which each node also holds values
+     * sticking out of its cell by up to half the cell size. Values are
+     * stored by their center and size alone, so moving a value only touches
+     * the tree when it leaves its node's cell, and the tree never needs
+     * rebalancing. The root doubles outwards for values outside of it.
+     *
+     * Handles stay valid until removed.
+     */
+    template<typename T, typename Scalar = double> class LooseQuadtree {
+    public:
+        using Handle = std::uint32_t;
+
+        static const Handle NONE = 0xFFFFFFFF;
+
+        /*
+         * The root cell is centered at the origin, no cell is smaller than
+         * minimumSize across
+         */
+        LooseQuadtree(Scalar rootSize, Scalar minimumSize) : nodes_(), items_(), freeItems_(), root_(), minimumSize_(minimumSize), size_() {
+            root_ = node(Point<Scalar>{}, rootSize / 2);
+        };
+
+        Handle insert(const T &value, const Bounds<Scalar> &bounds) {
+            Handle handle;
+            if (freeItems_.empty()) {
+                handle = static_cast<Handle> (items_.size());
+                items_.push_back(Item{});
+            } else {
+                handle = freeItems_.back();
+                freeItems_.pop_back();
+            }
+            Item &item = items_[handle];
+            item.value = value;
+            item.bounds = bounds;
+            link(handle);
+            ++size_;
+            return handle;
+        };
+
+        void update(Handle handle, const Bounds<Scalar> &bounds) {
+            Item &item = items_[handle];
+            item.bounds = bounds;
+            const Node &node = nodes_[item.node];
+            Scalar half = extent(bounds);
+            if (half <= node.half && (half * 2 > node.half || node.half < minimumSize_) && inside(node, center(bounds))) {
+                return;
+            }
+            unlink(handle);
+            link(handle);
+        };
+
+        void remove(Handle handle) {
+            unlink(handle);
+            items_[handle] = Item{};
+            freeItems_.push_back(handle);
+            --size_;
+        };
+
+        void clear() {
+            Scalar half = nodes_[root_].half;
+            nodes_.clear();
+            items_.clear();
+            freeItems_.clear();
+            size_ = 0;
+            root_ = node(Point<Scalar>{}, half);
+        };
+
+        const T &operator[](Handle handle) const {
+            return items_[handle].value;
+        };
+
+        const Bounds<Scalar> &bounds(Handle handle) const {
+            return items_[handle].bounds;
+        };
+
+        std::size_t size() const {
+            return size_;
+        };
+
+        /*
+         * Calls visitor with the handle of every value intersecting bounds
+         */
+        template<typename Visitor> void query(const Bounds<Scalar> &bounds, Visitor visitor) const {
+            std::vector<Handle> stack{root_};
+            while (!stack.empty()) {
+                const Node &node = nodes_[stack.back()];
+                stack.pop_back();
+                // the loose bounds reach half a cell beyond the cell
+                Scalar reach = node.half * 2;
+                if (!bounds.intersects(Bounds<Scalar>{node.center.x - reach, node.center.x + reach, node.center.y - reach, node.center.y + reach})) {
+                    continue;
+                }
+                for (Handle handle : node.items) {
+                    if (bounds.intersects(items_[handle].bounds)) {
+                        visitor(handle);
+                    }
+                }
+                for (Handle child : node.children) {
+                    if (child != NONE) {
+                        stack.push_back(child);
+                    }
+                }
+            }
+        };
+
+        template<typename Visitor> void query(Point<Scalar> point, Visitor visitor) const {
+            query(Bounds<Scalar>{point.x, point.x, point.y, point.y}, visitor);
+        };
+
+    private:
+
+        struct Node {
+            Point<Scalar> center;
+            Scalar half;
+            Handle children[4];
+            std::vector<Handle> items;
+        };
+
+        struct Item {
+            T value;
+            Bounds<Scalar> bounds;
+            Handle node;
+            Handle slot;
+
+            Item() : value(), bounds(), node(NONE), slot(NONE) {
+            };
+        };
+
+        std::vector<Node> nodes_;
+        std::vector<Item> items_;
+        std::vector<Handle> freeItems_;
+        Handle root_;
+        Scalar minimumSize_;
+        std::size_t size_;
+
+        static Point<Scalar> center(const Bounds<Scalar> &bounds) {
+            return Point<Scalar>{(bounds.left + bounds.right) / 2, (bounds.top + bounds.bottom) / 2};
+        };
+
+        static Scalar extent(const Bounds<Scalar> &bounds) {
+            return std::max(bounds.right - bounds.left, bounds.bottom - bounds.top) / 2;
+        };
+
+        static bool inside(const Node &node, Point<Scalar> point) {
+            return point.x >= node.center.x - node.half && point.x < node.center.x + node.half
+                    && point.y >= node.center.y - node.half && point.y < node.center.y + node.half;
+        };
+
+        Handle node(Point<Scalar> center, Scalar half) {
+            nodes_.push_back(Node{center, half, {NONE, NONE, NONE, NONE}, std::vector<Handle>{}});
+            return static_cast<Handle> (nodes_.size() - 1);
+        };
+
+        static unsigned quadrant(const Node &node, Point<Scalar> point) {
+            return (point.x >= node.center.x ? 1 : 0) + (point.y >= node.center.y ? 2 : 0);
+        };
+
+        /*
+         * Places the item in the smallest cell containing its center that is
+         * at least as large as the item
+         */
+        void link(Handle handle) {
+            Item &item = items_[handle];
+            Point<Scalar> center = this->center(item.bounds);
+            Scalar half = extent(item.bounds);
+            // values without a place anywhere stay in the root
+            bool finite = std::isfinite(center.x) && std::isfinite(center.y) && std::isfinite(half);
+            while (finite && (!inside(nodes_[root_], center) || half > nodes_[root_].half)) {
+                grow(center);
+            }
+            Handle current = root_;
+            while (finite && half * 2 <= nodes_[current].half && nodes_[current].half >= minimumSize_) {
+                unsigned quadrant = this->quadrant(nodes_[current], center);
+                Handle child = nodes_[current].children[quadrant];
+                if (child == NONE) {
+                    Scalar childHalf = nodes_[current].half / 2;
+                    Point<Scalar> childCenter{nodes_[current].center.x + (quadrant & 1 ? childHalf : -childHalf),
+                        nodes_[current].center.y + (quadrant & 2 ? childHalf : -childHalf)};
+                    child = node(childCenter, childHalf);
+                    nodes_[current].children[quadrant] = child;
+                }
+                current = child;
+            }
+            Node &node = nodes_[current];
+            item.node = current;
+            item.slot = static_cast<Handle> (node.items.size());
+            node.items.push_back(handle);
+        };
+
+        void unlink(Handle handle) {
+            Item &item = items_[handle];
+            std::vector<Handle> &items = nodes_[item.node].items;
+            items[item.slot] = items.back();
+            items_[items[item.slot]].slot = item.slot;
+            items.pop_back();
+            item.node = item.slot = NONE;
+        };
+
+        /*
+         * Makes the root a quadrant of a root twice its size, extending
+         * towards point
+         */
+        void grow(Point<Scalar> point) {
+            const Node &root = nodes_[root_];
+            Scalar half = root.half;
+            Point<Scalar> center{root.center.x + (point.x >= root.center.x ? half : -half), root.center.y + (point.y >= root.center.y ? half : -half)};
+            Handle old = root_;
+            root_ = node(center, half * 2);
+            nodes_[root_].children[quadrant(nodes_[root_], nodes_[old].center)] = old;
+        };
+
+        LooseQuadtree(const LooseQuadtree &) = delete;
+        LooseQuadtree &operator=(const LooseQuadtree &) = delete;
+    };
+
+}
+
+#endif	/* LOOSEQUADTREE_H */
+
@@ -0,0 +1,82 @@
+#include "MappedFile.h"
+#include "System.h"
+
+#include <utility>
+
+#ifdef OS_UNIX_LIKE
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace Core;
+
+MappedFile::MappedFile() : data_(), size_(), opened_() {
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const Path &path) {
+    close();
+#ifdef OS_UNIX_LIKE
+    int fd = ::open(path.data().c_str(), O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+    struct stat buffer;
+    if (fstat(fd, &buffer) != 0) {
+        ::close(fd);
+        return false;
+    }
+    std::size_t size = static_cast<std::size_t> (buffer.st_size);
+    if (size > 0) {
+        void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            ::close(fd);
+            return false;
+        }
+        data_ = data;
+    }
+    ::close(fd);
+    size_ = size;
+    opened_ = true;
+    return true;
+#endif
+#ifdef OS_WINDOWS
+    //TODO
+    return false;
+#endif
+}
+
+void MappedFile::close() {
+#ifdef OS_UNIX_LIKE
+    if (data_) {
+        munmap(data_, size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    opened_ = false;
+}
+
+void MappedFile::swap(MappedFile &file) {
+    std::swap(data_, file.data_);
+    std::swap(size_, file.size_);
+    std::swap(opened_, file.opened_);
+}
+
+bool MappedFile::opened() const {
+    return opened_;
+}
+
+const char *MappedFile::data() const {
+    return static_cast<const char *> (data_);
+}
+
+std::size_t MappedFile::size() const {
+    return size_;
+}
@@ -0,0 +1,50 @@
+/*
+ * File:   MappedFile.h
+ * Author: hans
+ *
+ * Created on October 19, 2026, 10:20 AM
+ */
+
+#ifndef MAPPEDFILE_H
+#define	MAPPEDFILE_H
+
+#include "Path.h"
+
+#include <cstddef>
+
+namespace Core {
+
+    /*
+     * Read only view of a whole file mapped into memory
+     */
+    class MappedFile {
+    public:
+        MappedFile();
+
+        ~MappedFile();
+
+        bool open(const Path &path);
+
+        void close();
+
+        void swap(MappedFile &file);
+
+        bool opened() const;
+
+        const char *data() const;
+
+        std::size_t size() const;
+
+    private:
+        void *data_;
+        std::size_t size_;
+        bool opened_;
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+    };
+
+}
+
+#endif	/* MAPPEDFILE_H */
+
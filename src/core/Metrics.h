@@ -87,6 +87,10 @@ namespace Core{
         bool contains(Point<Scalar> p) const{
             return contains(p.x, p.y);
         };
+        
+        bool intersects(const Bounds<Scalar> &b) const{
+            return left <= b.right && b.left <= right && top <= b.bottom && b.top <= bottom;
+        };
     };
     
 }
@@ -0,0 +1,266 @@
+#include "PackFile.h"
+#include "String.h"
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <cstring>
+
+#ifdef HAVE_ZLIB_H
+#include <zlib.h>
+#endif
+
+using namespace Core;
+
+namespace {
+
+    const char MAGIC[4] = {'S', 'P', 'P', 'K'};
+
+    const std::uint32_t VERSION = 1;
+
+    struct Header {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t entryCount;
+        std::uint32_t namePoolSize;
+    };
+
+    void collect(const Path &folder, const std::string &prefix, std::vector<std::pair<std::string, Path> > &files) {
+        for (const Path &child : folder.children()) {
+            std::string name{prefix + child.name()};
+            if (child.status().folder) {
+                collect(child, name + "/", files);
+            } else {
+                files.push_back(std::make_pair(name, child));
+            }
+        }
+    }
+
+    bool compress(const std::string &input, std::string &output) {
+#ifdef HAVE_ZLIB_H
+        uLongf length = compressBound(static_cast<uLong> (input.size()));
+        output.resize(length);
+        if (compress2(reinterpret_cast<Bytef *> (&output[0]), &length, reinterpret_cast<const Bytef *> (input.data()), static_cast<uLong> (input.size()), Z_BEST_COMPRESSION) == Z_OK && length < input.size()) {
+            output.resize(length);
+            return true;
+        }
+#else
+        (void) input;
+        (void) output;
+#endif
+        return false;
+    }
+
+    bool decompress(const char *input, std::size_t inputSize, std::size_t size, std::string &output) {
+#ifdef HAVE_ZLIB_H
+        output.resize(size);
+        uLongf length = static_cast<uLongf> (size);
+        return uncompress(reinterpret_cast<Bytef *> (&output[0]), &length, reinterpret_cast<const Bytef *> (input), static_cast<uLong> (inputSize)) == Z_OK && length == size;
+#else
+        (void) input;
+        (void) inputSize;
+        (void) size;
+        (void) output;
+        return false;
+#endif
+    }
+
+}
+
+PackException::PackException(std::string message) : std::runtime_error(message) {
+}
+
+PackFile::PackFile() : file_(), entries_(), names_(), count_(), modified_(), modifiedNanoseconds_() {
+}
+
+bool PackFile::open(const Path &path) {
+    close();
+    MappedFile file;
+    if (!file.open(path) || file.size() < sizeof (Header)) {
+        return false;
+    }
+    const Header *header = reinterpret_cast<const Header *> (file.data());
+    std::size_t indexEnd = sizeof (Header) + sizeof (Entry) * header->entryCount + header->namePoolSize;
+    if (!std::equal(MAGIC, MAGIC + sizeof (MAGIC), header->magic) || header->version != VERSION || file.size() < indexEnd) {
+        return false;
+    }
+    const Entry *entries = reinterpret_cast<const Entry *> (file.data() + sizeof (Header));
+    for (std::size_t i = 0; i < header->entryCount; ++i) {
+        if (entries[i].offset + entries[i].storedSize > file.size() || entries[i].nameOffset + entries[i].nameLength > header->namePoolSize) {
+            return false;
+        }
+    }
+    entries_ = entries;
+    names_ = reinterpret_cast<const char *> (entries + header->entryCount);
+    count_ = header->entryCount;
+    FileStatus status = path.status();
+    modified_ = status.modified;
+    modifiedNanoseconds_ = status.modifiedNanoseconds;
+    file_.swap(file);
+    return true;
+}
+
+void PackFile::close() {
+    file_.close();
+    entries_ = nullptr;
+    names_ = nullptr;
+    count_ = 0;
+}
+
+bool PackFile::opened() const {
+    return file_.opened();
+}
+
+std::size_t PackFile::size() const {
+    return count_;
+}
+
+std::string PackFile::name(std::size_t index) const {
+    return std::string{names_ + entries_[index].nameOffset, entries_[index].nameLength};
+}
+
+std::size_t PackFile::lowerBound(const std::string &name) const {
+    std::size_t low = 0;
+    std::size_t high = count_;
+    while (low < high) {
+        std::size_t middle = low + (high - low) / 2;
+        const Entry &entry = entries_[middle];
+        if (name.compare(0, std::string::npos, names_ + entry.nameOffset, entry.nameLength) > 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+const PackFile::Entry *PackFile::find(const std::string &name) const {
+    std::size_t index = lowerBound(name);
+    if (index < count_ && name.compare(0, std::string::npos, names_ + entries_[index].nameOffset, entries_[index].nameLength) == 0) {
+        return entries_ + index;
+    } else {
+        return nullptr;
+    }
+}
+
+bool PackFile::folder(const std::string &name) const {
+    if (name.empty()) {
+        return true;
+    }
+    std::string prefix{name + "/"};
+    std::size_t index = lowerBound(prefix);
+    return index < count_ && entries_[index].nameLength > prefix.length() && prefix.compare(0, prefix.length(), names_ + entries_[index].nameOffset, prefix.length()) == 0;
+}
+
+FileStatus PackFile::status(const std::string &name) const {
+    FileStatus status;
+    const Entry *entry = find(name);
+    if (entry) {
+        status.exists = true;
+        status.size = entry->size;
+        status.modified = modified_;
+        status.modifiedNanoseconds = modifiedNanoseconds_;
+    } else if (folder(name)) {
+        status.exists = true;
+        status.folder = true;
+        status.modified = modified_;
+        status.modifiedNanoseconds = modifiedNanoseconds_;
+    }
+    return status;
+}
+
+std::list<std::string> PackFile::children(const std::string &folder, bool foldersOnly) const {
+    std::list<std::string> children;
+    std::string prefix{folder.empty() ? folder : folder + "/"};
+    for (std::size_t i = lowerBound(prefix); i < count_; ++i) {
+        std::string child{name(i)};
+        if (child.compare(0, prefix.length(), prefix) != 0) {
+            break;
+        }
+        std::string::size_type separator = child.find('/', prefix.length());
+        if (separator == std::string::npos) {
+            if (!foldersOnly) {
+                children.push_back(child.substr(prefix.length()));
+            }
+        } else {
+            std::string name{child.substr(prefix.length(), separator - prefix.length())};
+            if (children.empty() || children.back() != name) {
+                children.push_back(name);
+            }
+        }
+    }
+    return children;
+}
+
+bool PackFile::read(const std::string &name, const char *&data, std::size_t &size, std::string &buffer) const {
+    const Entry *entry = find(name);
+    if (!entry) {
+        return false;
+    }
+    const char *stored = file_.data() + entry->offset;
+    if (entry->flags & COMPRESSED) {
+        if (!decompress(stored, static_cast<std::size_t> (entry->storedSize), static_cast<std::size_t> (entry->size), buffer)) {
+            throw PackException{toString("unable to decompress pack entry '", name, "'")};
+        }
+        data = buffer.data();
+    } else {
+        data = stored;
+    }
+    size = static_cast<std::size_t> (entry->size);
+    return true;
+}
+
+void PackFile::write(const Path &folder, std::ostream &output, bool compressEntries) {
+    std::vector<std::pair<std::string, Path> > files;
+    collect(folder, std::string{}, files);
+    std::sort(files.begin(), files.end(), [](const std::pair<std::string, Path> &first, const std::pair<std::string, Path> &second) {
+        return first.first < second.first;
+    });
+    std::vector<Entry> entries(files.size());
+    std::string names;
+    std::vector<std::string> contents(files.size());
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        std::ifstream input{files[i].second.data().c_str(), std::ios::binary};
+        if (!input.good()) {
+            throw PackException{toString("unable to read file '", files[i].second, "'")};
+        }
+        std::string content{std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>()};
+        Entry &entry = entries[i];
+        std::memset(&entry, 0, sizeof (Entry));
+        entry.nameOffset = static_cast<std::uint32_t> (names.size());
+        entry.nameLength = static_cast<std::uint32_t> (files[i].first.size());
+        entry.size = content.size();
+        names.append(files[i].first);
+        if (compressEntries && compress(content, contents[i])) {
+            entry.flags = COMPRESSED;
+        } else {
+            contents[i].swap(content);
+        }
+        entry.storedSize = contents[i].size();
+    }
+    std::uint64_t offset = sizeof (Header) + sizeof (Entry) * entries.size() + names.size();
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        entries[i].offset = offset;
+        offset += entries[i].storedSize;
+    }
+    Header header;
+    std::copy(MAGIC, MAGIC + sizeof (MAGIC), header.magic);
+    header.version = VERSION;
+    header.entryCount = static_cast<std::uint32_t> (entries.size());
+    header.namePoolSize = static_cast<std::uint32_t> (names.size());
+    output.write(reinterpret_cast<const char *> (&header), sizeof (Header));
+    output.write(reinterpret_cast<const char *> (entries.data()), static_cast<std::streamsize> (sizeof (Entry) * entries.size()));
+    output.write(names.data(), static_cast<std::streamsize> (names.size()));
+    for (const std::string &content : contents) {
+        output.write(content.data(), static_cast<std::streamsize> (content.size()));
+    }
+    if (!output.good()) {
+        throw PackException("unable to write pack file");
+    }
+}
+
@@ -0,0 +1,92 @@
+/*
+ * File:   PackFile.h
+ * Author: hans
+ *
+ * Created on October 19, 2026, 5:40 PM
+ */
+
+#ifndef PACKFILE_H
+#define	PACKFILE_H
+
+#include "Path.h"
+#include "MappedFile.h"
+
+#include <string>
+#include <list>
+#include <iostream>
+#include <stdexcept>
+#include <cstdint>
+
+namespace Core {
+
+    class PackException : public std::runtime_error {
+    public:
+        PackException(std::string message);
+    };
+
+    /*
+     * Archive of a folder tree: a header, an index of entries sorted by their
+     * '/' separated relative name, a name pool and the file contents. Entries
+     * are stored as is or deflated when zlib is available and it pays off.
+     * The archive is mapped, uncompressed entries are read in place.
+     */
+    class PackFile {
+    public:
+        static const std::uint32_t COMPRESSED = 1;
+
+        PackFile();
+
+        bool open(const Path &path);
+
+        void close();
+
+        bool opened() const;
+
+        std::size_t size() const;
+
+        FileStatus status(const std::string &name) const;
+
+        std::list<std::string> children(const std::string &folder, bool foldersOnly) const;
+
+        /*
+         * Points data at the contents of the entry, decompressing into buffer if needed
+         */
+        bool read(const std::string &name, const char *&data, std::size_t &size, std::string &buffer) const;
+
+        static void write(const Path &folder, std::ostream &output, bool compress = true);
+
+    private:
+
+        struct Entry {
+            std::uint64_t offset;
+            std::uint64_t storedSize;
+            std::uint64_t size;
+            std::uint32_t nameOffset;
+            std::uint32_t nameLength;
+            std::uint32_t flags;
+            std::uint32_t reserved;
+        };
+
+        MappedFile file_;
+        const Entry *entries_;
+        const char *names_;
+        std::size_t count_;
+        std::int64_t modified_;
+        std::int64_t modifiedNanoseconds_;
+
+        std::string name(std::size_t index) const;
+
+        std::size_t lowerBound(const std::string &name) const;
+
+        const Entry *find(const std::string &name) const;
+
+        bool folder(const std::string &name) const;
+
+        PackFile(const PackFile &) = delete;
+        PackFile &operator=(const PackFile &) = delete;
+    };
+
+}
+
+#endif	/* PACKFILE_H */
+
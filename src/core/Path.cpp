@@ -1,8 +1,9 @@
 #include "Path.h"
 #include "System.h"
+#include "DirectorySnapshot.h"
+#include "VirtualFileSystem.h"
 
 #include <iostream>
-#include <sstream>
 
 #ifdef OS_UNIX_LIKE
 #include <sys/stat.h>
@@ -17,19 +18,20 @@ using namespace Core;
 
 #ifdef OS_UNIX_LIKE
 
-const char SEPARATOR = '/';
+const char Path::SEPARATOR = '/';
 
 #endif
 #ifdef OS_WINDOWS
-const char SEPARATOR = '\\';
+const char Path::SEPARATOR = '\\';
 #endif
 
 std::string concatenate(const std::string& parent, const std::string& child) {
-    std::ostringstream buffer;
-    buffer << parent;
-    buffer.put(SEPARATOR);
-    buffer << child;
-    return buffer.str();
+    std::string result;
+    result.reserve(parent.length() + child.length() + 1);
+    result.append(parent);
+    result.push_back(Path::SEPARATOR);
+    result.append(child);
+    return result;
 }
 
 Path::Path() : data_() {
@@ -66,6 +68,10 @@ Path Path::child(std::string name) const{
 }
 
 bool Path::fileExists() const {
+    FileStatus cached;
+    if(VirtualFileSystem::global().status(data_, cached) || DirectorySnapshot::global().status(data_, cached)){
+        return cached.exists;
+    }
 #ifdef OS_UNIX_LIKE
     struct stat buffer;
     return (stat(data_.c_str(), &buffer) == 0);
@@ -76,6 +82,10 @@ bool Path::fileExists() const {
 }
 
 bool Path::folderExists() const {
+    FileStatus cached;
+    if(VirtualFileSystem::global().status(data_, cached) || DirectorySnapshot::global().status(data_, cached)){
+        return cached.folder;
+    }
 #ifdef OS_UNIX_LIKE
     DIR* dir = opendir(data_.c_str());
     if (dir) {
@@ -90,6 +100,30 @@ bool Path::folderExists() const {
 #endif
 }
 
+FileStatus::FileStatus() : exists(), folder(), size(), modified(), modifiedNanoseconds(){
+}
+
+FileStatus Path::status() const{
+    FileStatus status;
+    if(VirtualFileSystem::global().status(data_, status) || DirectorySnapshot::global().status(data_, status)){
+        return status;
+    }
+#ifdef OS_UNIX_LIKE
+    struct stat buffer;
+    if(stat(data_.c_str(), &buffer) == 0){
+        status.exists = true;
+        status.folder = S_ISDIR(buffer.st_mode);
+        status.size = static_cast<std::uint64_t>(buffer.st_size);
+        status.modified = static_cast<std::int64_t>(buffer.st_mtime);
+        status.modifiedNanoseconds = static_cast<std::int64_t>(buffer.st_mtim.tv_nsec);
+    }
+#endif
+#ifdef OS_WINDOWS
+    //TODO
+#endif
+    return status;
+}
+
 bool Path::createFile() const{
 #ifdef OS_UNIX_LIKE
     int pfd;
@@ -97,6 +131,7 @@ bool Path::createFile() const{
         return false;
     }else{
         close(pfd);
+        DirectorySnapshot::global().invalidate(parent());
         return true;
     }
 #endif
@@ -108,6 +143,7 @@ bool Path::createFile() const{
 bool Path::createFolder() const{
 #ifdef OS_UNIX_LIKE
     if(mkdir(data_.c_str(), S_IRWXU) == 0){
+        DirectorySnapshot::global().invalidate(parent());
         return true;
     }else if(errno == EEXIST){
         return false;
@@ -123,6 +159,9 @@ bool Path::createFolder() const{
 
 std::list<Path> Path::children() const{
     std::list<Path> children;
+    if(VirtualFileSystem::global().children(data_, false, children) || DirectorySnapshot::global().children(data_, false, children)){
+        return children;
+    }
 #ifdef OS_UNIX_LIKE
     DIR *handle = opendir(data_.data());
     struct dirent *child = readdir(handle);
@@ -142,6 +181,9 @@ std::list<Path> Path::children() const{
 
 std::list<Path> Path::childFolders() const{
     std::list<Path> children;
+    if(VirtualFileSystem::global().children(data_, true, children) || DirectorySnapshot::global().children(data_, true, children)){
+        return children;
+    }
 #ifdef OS_UNIX_LIKE
     DIR *handle = opendir(data_.data());
     if(handle){
@@ -163,11 +205,15 @@ std::list<Path> Path::childFolders() const{
     return children;
 };
 
+bool Path::openFile(FileInput &input) const{
+    return VirtualFileSystem::global().open(data_, input) || input.openFile(data_);
+}
+
 std::string Path::data() const{
     return data_;
 }
 
-std::ostream &operator<<(std::ostream &output, const Core::Path &path){
+std::ostream &Core::operator<<(std::ostream &output, const Core::Path &path){
     return output << path.data();
 };
 
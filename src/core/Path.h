@@ -13,11 +13,27 @@
 #include <fstream>
 #include <list>
 #include <stdexcept>
+#include <cstdint>
 
 namespace Core{
     
+    class FileInput;
+    
+    struct FileStatus{
+        bool exists;
+        bool folder;
+        std::uint64_t size;
+        std::int64_t modified;
+        // nanoseconds within the modified second, 0 where not available
+        std::int64_t modifiedNanoseconds;
+        
+        FileStatus();
+    };
+    
     class Path{
     public:
+        static const char SEPARATOR;
+        
         Path();
         Path(std::string data);
         Path(Path parent, std::string data);
@@ -36,12 +52,16 @@ namespace Core{
         
         bool folderExists() const;
         
+        FileStatus status() const;
+        
         bool createFile() const;
         
         bool createFolder() const;
         
         std::string data() const;
         
+        bool openFile(FileInput &input) const;
+        
         template<typename Char, typename CharTraits> bool openFile(std::basic_ofstream<Char,CharTraits> &output) const{
             output.open(data_.c_str());
             return output.good();
@@ -62,9 +82,9 @@ namespace Core{
     public:
         PathException(std::string message);
     };
+    
+    std::ostream &operator<<(std::ostream &output, const Path &path);
 }
 
-std::ostream &operator<<(std::ostream &output, const Core::Path &path);
-
 #endif	/* PATH_H */
 
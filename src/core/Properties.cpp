@@ -16,4 +16,8 @@ PropertyNotFoundException::PropertyNotFoundException(std::string message) : Prop
 
 PropertySyntaxException::PropertySyntaxException(std::string message, int line) : PropertyException(message), line_(line){
 
+}
+
+int PropertySyntaxException::line() const{
+    return line_;
 }
\ No newline at end of file
@@ -12,9 +12,17 @@
 #include <sstream>
 #include <unordered_map>
 #include <map>
+#include <list>
+#include <memory>
+#include <limits>
+#include <cmath>
 #include <locale>
 #include <stdexcept>
 #include <type_traits>
+#include <algorithm>
+#include <vector>
+#include <thread>
+#include <exception>
 
 #include "Parser.h"
 #include "CharacterBuffer.h"
@@ -42,15 +50,181 @@ namespace Core {
         ConvertPropertyException(std::string message);
     };
 
+    /*
+     * Locale independent number parsing, works on any character type whose
+     * traits map the ASCII digits to their usual code points
+     */
+    template<typename Char, typename CharTraits> class NumericParser {
+    private:
+
+        static bool isDigit(Char c) {
+            typename CharTraits::int_type i = CharTraits::to_int_type(c);
+            return i >= '0' && i <= '9';
+        };
+
+        static unsigned int digit(Char c) {
+            return static_cast<unsigned int> (CharTraits::to_int_type(c) - '0');
+        };
+
+        static bool is(Char c, char expected) {
+            return CharTraits::eq_int_type(CharTraits::to_int_type(c), expected);
+        };
+
+        static bool isBlank(Char c) {
+            typename CharTraits::int_type i = CharTraits::to_int_type(c);
+            return i == ' ' || i == '\t' || i == '\r' || i == '\n' || i == 0x0B || i == 0x0C;
+        };
+
+        static bool parseSign(const Char *&current, const Char *end) {
+            if (current != end && (is(*current, '-') || is(*current, '+'))) {
+                return is(*current++, '-');
+            }
+            return false;
+        };
+
+        static bool parseUnsigned(const Char *&current, const Char *end, unsigned long long limit, unsigned long long &output) {
+            if (current == end || !isDigit(*current)) {
+                return false;
+            }
+            unsigned long long result = 0;
+            while (current != end && isDigit(*current)) {
+                unsigned int d = digit(*current);
+                if (d > limit || result > (limit - d) / 10) {
+                    return false;
+                }
+                result = result * 10 + d;
+                ++current;
+            }
+            output = result;
+            return true;
+        };
+
+        static long double powerOfTen(int exponent) {
+            static const double exact[] = {
+                1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+            };
+            if (exponent >= 0 && exponent <= 22) {
+                return exact[exponent];
+            } else {
+                return std::pow(10.0L, exponent);
+            }
+        };
+
+        template<typename Output> static bool parseNumber(const Char *current, const Char *end, Output &output, std::true_type, std::false_type) {
+            bool negative = parseSign(current, end);
+            unsigned long long limit = static_cast<unsigned long long> (std::numeric_limits<Output>::max());
+            if (negative) {
+                if (std::is_unsigned<Output>::value) {
+                    limit = 0;
+                } else {
+                    ++limit;
+                }
+            }
+            unsigned long long value;
+            if (parseUnsigned(current, end, limit, value) && current == end) {
+                output = negative ? static_cast<Output> (-static_cast<long long> (value - 1) - 1) : static_cast<Output> (value);
+                return true;
+            } else {
+                return false;
+            }
+        };
+
+        template<typename Output> static bool parseNumber(const Char *current, const Char *end, Output &output, std::false_type, std::true_type) {
+            bool negative = parseSign(current, end);
+            unsigned long long mantissa = 0;
+            int digits = 0;
+            int exponent = 0;
+            bool found = false;
+            for (; current != end && isDigit(*current); ++current, found = true) {
+                if (digits < 19) {
+                    mantissa = mantissa * 10 + digit(*current);
+                    if (mantissa) {
+                        ++digits;
+                    }
+                } else {
+                    ++exponent;
+                }
+            }
+            if (current != end && is(*current, '.')) {
+                for (++current; current != end && isDigit(*current); ++current, found = true) {
+                    if (digits < 19) {
+                        mantissa = mantissa * 10 + digit(*current);
+                        if (mantissa) {
+                            ++digits;
+                        }
+                        --exponent;
+                    }
+                }
+            }
+            if (!found) {
+                return false;
+            }
+            if (current != end && (is(*current, 'e') || is(*current, 'E'))) {
+                ++current;
+                bool negativeExponent = parseSign(current, end);
+                unsigned long long value;
+                if (!parseUnsigned(current, end, 100000, value)) {
+                    return false;
+                }
+                exponent += negativeExponent ? -static_cast<int> (value) : static_cast<int> (value);
+            }
+            if (current != end) {
+                return false;
+            }
+            long double result;
+            if (mantissa == 0) {
+                // any exponent, not 0 times infinity
+                result = 0;
+            } else if (mantissa < (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+                double exact = static_cast<double> (mantissa);
+                result = exponent < 0 ? exact / static_cast<double> (powerOfTen(-exponent)) : exact * static_cast<double> (powerOfTen(exponent));
+            } else if (exponent < 0) {
+                result = static_cast<long double> (mantissa) / powerOfTen(-exponent);
+            } else {
+                result = static_cast<long double> (mantissa) * powerOfTen(exponent);
+            }
+            output = static_cast<Output> (negative ? -result : result);
+            return true;
+        };
+
+        static bool parseNumber(const Char *current, const Char *end, bool &output, std::true_type, std::false_type) {
+            static const char *names[] = {"false", "true", "0", "1"};
+            for (unsigned int i = 0; i < 4; ++i) {
+                const Char *c = current;
+                const char *n = names[i];
+                while (c != end && *n && is(*c, *n)) {
+                    ++c;
+                    ++n;
+                }
+                if (c == end && !*n) {
+                    output = (i % 2) == 1;
+                    return true;
+                }
+            }
+            return false;
+        };
+
+    public:
+
+        template<typename Output> static bool parse(const Char *begin, const Char *end, Output &output) {
+            while (begin != end && isBlank(*begin)) {
+                ++begin;
+            }
+            while (begin != end && isBlank(*(end - 1))) {
+                --end;
+            }
+            return parseNumber(begin, end, output, typename std::is_integral<Output>::type{}, typename std::is_floating_point<Output>::type{});
+        };
+
+    };
+
     template<typename Char, typename CharTraits, typename Output> class BasicNumericConverter {
         static_assert(std::is_integral<Output>::value || std::is_floating_point<Output>::value, "can only be used to convert integral types");
-    protected:
+    public:
 
         static void convert(const std::basic_string<Char, CharTraits> &input, Output &output) {
-            std::string buffer{input.begin(), input.end()};
-            std::ostringstream converter{buffer};
-            converter >> output;
-            if (converter.bad()) {
+            if (!NumericParser<Char, CharTraits>::parse(input.data(), input.data() + input.length(), output)) {
                 throw ConvertPropertyException("unable to convert value");
             }
         };
@@ -60,9 +234,10 @@ namespace Core {
     public:
 
         static void convert(const std::basic_string<Char, CharTraits> &input, Output &output) {
-            std::basic_ostringstream<Char, CharTraits> buffer{input};
+            std::basic_istringstream<Char, CharTraits> buffer{input};
+            buffer.imbue(std::locale::classic());
             buffer >> output;
-            if (buffer.bad() || !buffer.eof()) {
+            if (buffer.fail() || !(buffer >> std::ws).eof()) {
                 throw ConvertPropertyException("unable to convert value");
             }
         };
@@ -72,13 +247,13 @@ namespace Core {
     public:
 
         static void convert(const std::basic_string<Char, CharTraits> &input, Output &output) {
-            typename std::conditional <
-                    (!(std::is_same<char, Char>::value && std::is_same<std::char_traits<char>, CharTraits>::value)) ||
+            using Converter = typename std::conditional <
                     std::is_integral<Output>::value ||
                     std::is_floating_point<Output>::value,
                     BasicNumericConverter<Char, CharTraits, Output>,
                     BasicConverterDelegate<Char, CharTraits, Output>
-                    >::convert(input, output);
+                    >::type;
+            Converter::convert(input, output);
         };
 
     };
@@ -101,27 +276,18 @@ namespace Core {
 
         using Iterator = typename String::const_iterator;
 
-        static ParseState parse(Char c) {
-            if (CharTraits::to_int_type(c) == ',') {
-                return ParseState::DELIMITER;
-            } else {
-                return ParseState::CONTINUE;
-            }
-        };
-
         static void convert(const std::basic_string<Char, CharTraits> &input, std::list<Element> &output) {
-            ParseState state = ParseState::CONTINUE;
-            Range<Iterator> range{input.begin(), input.end()};
-            Iterator begin = range.begin();
-            while (state == ParseState::CONTINUE) {
-                state = Core::parseCode(range, BasicConverter<Char, CharTraits, std::list < Element>>::parse);
-                Element element;
-                BasicConverter<Char, CharTraits, Element>::convert(String{begin, range.begin()}, element);
-                output.push_back(element);
-                if (state == ParseState::DELIMITER) {
-                    state = ParseState::CONTINUE;
+            output.clear();
+            Iterator begin = input.begin();
+            for (Iterator i = input.begin(); i != input.end(); ++i) {
+                if (CharTraits::eq_int_type(CharTraits::to_int_type(*i), ',')) {
+                    output.emplace_back();
+                    BasicConverter<Char, CharTraits, Element>::convert(String{begin, i}, output.back());
+                    begin = i + 1;
                 }
             }
+            output.emplace_back();
+            BasicConverter<Char, CharTraits, Element>::convert(String{begin, input.end()}, output.back());
         };
 
     };
@@ -193,6 +359,7 @@ namespace Core {
     public:
         using Key = std::basic_string<Char, CharTraits>;
         using Value = Key;
+        using Slice = Core::Range<const Char *>;
     private:
         Format format_;
 
@@ -260,7 +427,9 @@ namespace Core {
                         break;
                     case ParseState::DELIMITER:
                         add(buffer, begin, range.begin());
-                        ++range;
+                        if (!format_.isNewLine(*range)) {
+                            ++range;
+                        }
                         break;
                     case ParseState::ERROR:
                         throw PropertyException("unexpected character");
@@ -280,7 +449,7 @@ namespace Core {
         template<typename Range> void skipKeyValueDelimiter(Range &range) {
             skipWhitespace(range);
             if (range) {
-                if (format_.isKeyValueDelimiter(*range) || format_.isWhitespace(*range)) {
+                if (format_.isKeyValueDelimiter(*range) || (format_.isWhitespace(*range) && !format_.isNewLine(*range))) {
                     ++range;
                 }
             } else {
@@ -350,12 +519,150 @@ namespace Core {
             }
         };
 
+        /*
+         * Contiguous input: keys and values are reported as slices of the
+         * input buffer and only copied to a scratch buffer if they contain escapes
+         */
+
+        Key keyScratch_;
+        Value valueScratch_;
+
+        const Char *skipBlank(const Char *current, const Char *end) const {
+            while (current != end && format_.isWhitespace(*current) && !format_.isNewLine(*current)) {
+                ++current;
+            }
+            return current;
+        };
+
+        template<typename Predicate> const Char *parseSlice(const Char *current, const Char *end, Key &scratch, Slice &slice, ParseState &state, Predicate pred) {
+            const Char *begin = current;
+            bool escaped = false;
+            state = ParseState::END;
+            while (current != end) {
+                state = pred(*current);
+                if (state == ParseState::ESCAPE) {
+                    if (escaped) {
+                        scratch.append(begin, current);
+                    } else {
+                        scratch.assign(begin, current);
+                        escaped = true;
+                    }
+                    ++current;
+                    if (current == end) {
+                        throw PropertyException("unexpected end of input, expected escape code");
+                    }
+                    scratch.push_back(format_.unescape(*current));
+                    ++current;
+                    begin = current;
+                    state = ParseState::END;
+                } else if (state == ParseState::CONTINUE) {
+                    ++current;
+                } else {
+                    break;
+                }
+            }
+            if (escaped) {
+                scratch.append(begin, current);
+                slice = Slice{scratch.data(), scratch.data() + scratch.length()};
+            } else {
+                slice = Slice{begin, current};
+            }
+            return current;
+        };
+
+        const Char *parseKey(const Char *current, const Char *end, Slice &key) {
+            auto keyPred = [&](Char c) -> ParseState {
+                if (format_.isKeyValueDelimiter(c) || format_.isWhitespace(c)) {
+                    return ParseState::DELIMITER;
+                } else if (format_.isEscapeFlag(c)) {
+                    return ParseState::ESCAPE;
+                } else if (format_.isNewLine(c) || format_.isComment(c)) {
+                    return ParseState::ERROR;
+                } else {
+                    return ParseState::CONTINUE;
+                }
+            };
+            ParseState state;
+            current = parseSlice(current, end, keyScratch_, key, state, keyPred);
+            if (state == ParseState::ERROR) {
+                throw PropertyException("unexpected character");
+            } else if (state == ParseState::END) {
+                throw PropertyException("unexpected end of input");
+            }
+            return format_.isNewLine(*current) ? current : current + 1;
+        };
+
+        const Char *skipKeyValueDelimiter(const Char *current, const Char *end) const {
+            current = skipBlank(current, end);
+            if (current == end) {
+                throw PropertyException("unexpected end of input");
+            } else if (format_.isKeyValueDelimiter(*current) || (format_.isWhitespace(*current) && !format_.isNewLine(*current))) {
+                ++current;
+            }
+            return current;
+        };
+
+        const Char *parseValue(const Char *current, const Char *end, Slice &value) {
+            auto valuePred = [&](Char c) -> ParseState {
+                if (format_.isEscapeFlag(c)) {
+                    return ParseState::ESCAPE;
+                } else if (format_.isNewLine(c) || format_.isComment(c)) {
+                    return ParseState::DELIMITER;
+                } else {
+                    return ParseState::CONTINUE;
+                }
+            };
+            ParseState state;
+            return parseSlice(current, end, valueScratch_, value, state, valuePred);
+        };
+
+        const Char *skipToEndOfLine(const Char *current, const Char *end) const {
+            while (current != end && !format_.isNewLine(*current)) {
+                ++current;
+            }
+            return current == end ? current : current + 1;
+        };
+
+        template<typename ParserListener> const Char *parseLine(const Char *current, const Char *end, ParserListener &listener) {
+            current = skipBlank(current, end);
+            if (current != end) {
+                if (format_.isComment(*current)) {
+                    while (current != end && !format_.isNewLine(*current)) {
+                        ++current;
+                    }
+                } else if (format_.isNewLine(*current)) {
+                    ++current;
+                } else {
+                    Slice key;
+                    Slice value;
+                    current = parseKey(current, end, key);
+                    current = skipKeyValueDelimiter(current, end);
+                    current = parseValue(current, end, value);
+                    current = skipToEndOfLine(current, end);
+                    listener.addProperty(key, value);
+                }
+            }
+            return current;
+        };
+
+        template<typename ParserListener> void parseContiguous(const Char *current, const Char *end, ParserListener &listener) {
+            int line = 0;
+            try {
+                while (current != end) {
+                    current = parseLine(current, end, listener);
+                    ++line;
+                }
+            } catch (PropertyException &e) {
+                listener.error(std::string{e.what()}, line);
+            }
+        };
+
     public:
 
-        PropertyParser(Format format) : format_(format) {
+        PropertyParser(Format format) : format_(format), keyScratch_(), valueScratch_() {
         };
 
-        PropertyParser() : format_() {
+        PropertyParser() : format_(), keyScratch_(), valueScratch_() {
         };
 
         const Format &format() const {
@@ -374,6 +681,14 @@ namespace Core {
             }
         };
 
+        template<typename ParserListener> void parse(Core::Range<const Char *> range, ParserListener &listener) {
+            parseContiguous(range.begin(), range.end(), listener);
+        };
+
+        template<typename ParserListener> void parse(Core::Range<Char *> range, ParserListener &listener) {
+            parseContiguous(range.begin(), range.end(), listener);
+        };
+
     };
 
     template<
@@ -410,9 +725,47 @@ namespace Core {
                 ] = Value{value.begin(), value.end()};
             };
 
+            void addProperty(const typename Parser::Slice &key, const typename Parser::Slice &value) {
+                map_[Key{key.begin(), key.end()}
+                ] = Value{value.begin(), value.end()};
+            };
+
+        };
+
+        /*
+         * Returns the position after the first newline at or after from that
+         * really ends a line, i.e. is not escaped as a line continuation
+         */
+        const ExternChar *nextLine(const ExternChar *begin, const ExternChar *from, const ExternChar *end) const {
+            const Format &format = parser_.format();
+            for (; from != end; ++from) {
+                if (format.isNewLine(*from)) {
+                    std::size_t escapes = 0;
+                    for (const ExternChar *c = from; c != begin && format.isEscapeFlag(*(c - 1)); --c) {
+                        ++escapes;
+                    }
+                    if (escapes % 2 == 0) {
+                        return from + 1;
+                    }
+                }
+            }
+            return end;
         };
+
+        std::size_t countLines(const ExternChar *begin, const ExternChar *end) const {
+            std::size_t lines = 0;
+            for (; begin != end; ++begin) {
+                if (parser_.format().isNewLine(*begin)) {
+                    ++lines;
+                }
+            }
+            return lines;
+        };
+
     public:
 
+        static const std::size_t MIN_PARALLEL_CHUNK_SIZE = 1 << 16;
+
         PropertyLoader(Format format) : parser_(format) {
         };
 
@@ -424,6 +777,67 @@ namespace Core {
             parser_.parse(Core::Range<Iterator>{begin, end}, builder);
         };
 
+        /*
+         * Splits large contiguous input at line boundaries and parses the chunks
+         * on separate threads. Chunks are merged in input order, so later
+         * definitions of a key win exactly as they do when loading sequentially.
+         * Input smaller than two chunks is loaded on the calling thread.
+         */
+        template<typename Map> void loadParallel(const ExternChar *begin, const ExternChar *end, Map &map, unsigned int threadCount = 0) {
+            if (threadCount == 0) {
+                threadCount = std::max(1U, std::thread::hardware_concurrency());
+            }
+            std::size_t length = static_cast<std::size_t> (end - begin);
+            std::size_t chunkCount = std::min<std::size_t>(threadCount, length / MIN_PARALLEL_CHUNK_SIZE);
+            if (chunkCount < 2) {
+                load(begin, end, map);
+                return;
+            }
+            std::vector<const ExternChar *> bounds{begin};
+            for (std::size_t i = 1; i < chunkCount && bounds.back() != end; ++i) {
+                const ExternChar *from = std::max(bounds.back(), begin + (length / chunkCount) * i);
+                bounds.push_back(nextLine(begin, from, end));
+            }
+            if (bounds.back() != end) {
+                bounds.push_back(end);
+            }
+            chunkCount = bounds.size() - 1;
+            std::vector<Map> maps{chunkCount};
+            std::vector<std::exception_ptr> errors{chunkCount};
+            auto loadChunk = [&](std::size_t chunk) {
+                try {
+                    Parser parser{parser_};
+                    PropertyMapBuilder<Map> builder{maps[chunk]};
+                    parser.parse(Core::Range<const ExternChar *>{bounds[chunk], bounds[chunk + 1]}, builder);
+                } catch (...) {
+                    errors[chunk] = std::current_exception();
+                }
+            };
+            std::vector<std::thread> threads;
+            for (std::size_t chunk = 1; chunk < chunkCount; ++chunk) {
+                threads.emplace_back(loadChunk, chunk);
+            }
+            loadChunk(0);
+            for (auto &thread : threads) {
+                thread.join();
+            }
+            for (std::size_t chunk = 0; chunk < chunkCount; ++chunk) {
+                if (errors[chunk]) {
+                    try {
+                        std::rethrow_exception(errors[chunk]);
+                    } catch (PropertySyntaxException &e) {
+                        int line = e.line() + static_cast<int> (countLines(begin, bounds[chunk]));
+                        throw PropertySyntaxException{e.what(), line};
+                    }
+                }
+            }
+            for (auto &chunkMap : maps) {
+                for (auto &entry : chunkMap) {
+                    map[entry.first] = std::move(entry.second);
+                }
+            }
+        };
+
         template<typename Map> void loadUTF8(std::istream &input, Map &map) {
             Core::UTF8ToUTF32InputBuffer<ExternChar, char> buffer;
             buffer.read(input);
@@ -455,13 +869,73 @@ namespace Core {
     public:
         using String = std::basic_string<Char, CharTraits>;
     private:
+
+        /*
+         * Holds the last conversion result so repeated reads of the same type
+         * do not convert the string again
+         */
+        class Cache {
+        public:
+
+            virtual ~Cache() {
+            };
+
+            virtual Cache *clone() const = 0;
+
+            virtual const void *type() const = 0;
+        };
+
+        template<typename Output> class TypedCache : public Cache {
+        public:
+            Output value;
+
+            TypedCache() : value() {
+            };
+
+            Cache *clone() const {
+                TypedCache<Output> *cache = new TypedCache<Output>{};
+                cache->value = value;
+                return cache;
+            };
+
+            const void *type() const {
+                return typeId<Output>();
+            };
+        };
+
+        template<typename Output> static const void *typeId() {
+            static const char id{};
+            return &id;
+        };
+
         String value_;
+        mutable std::unique_ptr<Cache> cache_;
     public:
 
-        PropertyValue() : value_() {
+        PropertyValue() : value_(), cache_() {
+        };
+
+        PropertyValue(String value) : value_(std::move(value)), cache_() {
+        };
+
+        PropertyValue(const PropertyValue &value) : value_(value.value_), cache_(value.cache_ ? value.cache_->clone() : nullptr) {
+        };
+
+        PropertyValue(PropertyValue &&value) : value_(std::move(value.value_)), cache_(std::move(value.cache_)) {
+        };
+
+        PropertyValue &operator=(const PropertyValue &value) {
+            if (this != &value) {
+                value_ = value.value_;
+                cache_.reset(value.cache_ ? value.cache_->clone() : nullptr);
+            }
+            return *this;
         };
 
-        PropertyValue(String value) : value_(value) {
+        PropertyValue &operator=(PropertyValue &&value) {
+            value_ = std::move(value.value_);
+            cache_ = std::move(value.cache_);
+            return *this;
         };
 
         operator String() const {
@@ -476,15 +950,32 @@ namespace Core {
             output << value_;
         };
 
+        /*
+         * Converts on first access, later calls for the same type return the cached result.
+         * Not safe for concurrent first access; call cache() after loading for values shared between threads
+         */
+        template<typename Output> const Output &as() const {
+            if (!cache_ || cache_->type() != typeId<Output>()) {
+                std::unique_ptr<TypedCache<Output> > cache{new TypedCache<Output>{}};
+                ConverterPolicy::execute(value_, cache->value);
+                cache_.reset(cache.release());
+            }
+            return static_cast<const TypedCache<Output> *> (cache_.get())->value;
+        };
+
         template<typename Output> void get(Output &output) const {
-            ConverterPolicy::execute(value_, output);
+            output = as<Output>();
+        };
+
+        template<typename Output> void cache() const {
+            as<Output>();
         };
 
     };
 
 }
 
-template<typename Char, typename CharTraits, typename ConverterPolicy> std::basic_ostream<Char, CharTraits> &operator<<(std::basic_ostream<Char, CharTraits> &output, Core::PropertyValue<Char, CharTraits, ConverterPolicy> value) {
+template<typename Char, typename CharTraits, typename ConverterPolicy> std::basic_ostream<Char, CharTraits> &operator<<(std::basic_ostream<Char, CharTraits> &output, const Core::PropertyValue<Char, CharTraits, ConverterPolicy> &value) {
     value.write(output);
     return output;
 };
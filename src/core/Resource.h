@@ -1,4 +1,4 @@
-/* 
+/*
  * File:   Resource.h
  * Author: hans
  *
@@ -9,8 +9,13 @@
 #define	RESOURCE_H
 
 #include "String.h"
+#include "Hash.h"
 
-#include <unordered_map>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <functional>
 #include <stdexcept>
 
 namespace Core {
@@ -33,17 +38,83 @@ namespace Core {
         Key key_;
     };
 
+    /*
+     * Small integer naming a resource in a bundle, valid until the bundle is unloaded
+     */
+    class ResourceHandle {
+    public:
+
+        ResourceHandle() : index_(INVALID) {
+        };
+
+        explicit ResourceHandle(std::uint32_t index) : index_(index) {
+        };
+
+        std::uint32_t index() const {
+            return index_;
+        };
+
+        bool valid() const {
+            return index_ != INVALID;
+        };
+
+        bool operator==(const ResourceHandle &handle) const {
+            return index_ == handle.index_;
+        };
+
+        bool operator!=(const ResourceHandle &handle) const {
+            return index_ != handle.index_;
+        };
+
+    private:
+        static const std::uint32_t INVALID = 0xFFFFFFFFU;
+
+        std::uint32_t index_;
+    };
+
+    template<typename Key> class ResourceKeyTraits {
+    public:
+
+        static std::size_t hash(const Key &key) {
+            return std::hash<Key>{}(key);
+        };
+
+        static bool equal(const Key &first, const Key &second) {
+            return first == second;
+        };
+    };
+
+    /*
+     * String keys can be looked up with character pointers without building a string
+     */
+    template<> class ResourceKeyTraits<std::string> {
+    public:
+
+        static std::size_t hash(const char *key) {
+            return static_cast<std::size_t> (Core::hash(key, std::strlen(key)));
+        };
+
+        static std::size_t hash(const std::string &key) {
+            return static_cast<std::size_t> (Core::hash(key.data(), key.length()));
+        };
+
+        static bool equal(const std::string &first, const char *second) {
+            return first.compare(second) == 0;
+        };
+
+        static bool equal(const std::string &first, const std::string &second) {
+            return first == second;
+        };
+    };
+
     template<typename Key, typename Resource> class BasicResourcePolicy {
     protected:
 
         BasicResourcePolicy() {
         };
 
-        void check(std::unordered_map<Key, const Resource *> & resources, const Key &key) {
-            auto found = resources.find(key);
-            if(found != resources.end()){
-                delete found->second;
-            }
+        void replace(const Resource *resource) {
+            delete resource;
         };
 
         void destroy(const Resource *resource) {
@@ -51,37 +122,150 @@ namespace Core {
         }
     };
 
-    template<typename Key_, typename Resource_, typename ResourcePolicy = BasicResourcePolicy<Key_, Resource_> > class ResourceBundle : private ResourcePolicy {
+    /*
+     * Resources are stored densely in insertion order; an open addressing index
+     * maps keys to their position, which doubles as the resource handle
+     */
+    template<typename Key, typename Resource, typename KeyTraits = ResourceKeyTraits<Key> > class ResourceTable {
+    public:
+
+        ResourceTable() : keys_(), resources_(), index_() {
+        };
+
+        template<typename LookupKey> ResourceHandle find(const LookupKey &key) const {
+            if (index_.empty()) {
+                return ResourceHandle{};
+            }
+            std::uint32_t found = index_[slot(key)];
+            return found ? ResourceHandle{found - 1} : ResourceHandle{};
+        };
+
+        /*
+         * Returns the resource previously stored under the key, if any
+         */
+        const Resource *insert(const Key &key, const Resource *resource, ResourceHandle &handle) {
+            if ((keys_.size() + 1) * 2 > index_.size()) {
+                rehash(index_.empty() ? 16 : index_.size() * 2);
+            }
+            std::size_t position = slot(key);
+            if (index_[position]) {
+                handle = ResourceHandle{index_[position] - 1};
+                const Resource *replaced = resources_[handle.index()];
+                resources_[handle.index()] = resource;
+                return replaced;
+            } else {
+                keys_.push_back(key);
+                resources_.push_back(resource);
+                index_[position] = static_cast<std::uint32_t> (keys_.size());
+                handle = ResourceHandle{static_cast<std::uint32_t> (keys_.size() - 1)};
+                return nullptr;
+            }
+        };
+
+        const Resource *at(ResourceHandle handle) const {
+            if (handle.index() < resources_.size()) {
+                return resources_[handle.index()];
+            } else {
+                throw ResourceException("invalid resource handle");
+            }
+        };
+
+        const Key &key(ResourceHandle handle) const {
+            return keys_[handle.index()];
+        };
+
+        const std::vector<const Resource *> &resources() const {
+            return resources_;
+        };
+
+        std::size_t size() const {
+            return resources_.size();
+        };
+
+        void clear() {
+            keys_.clear();
+            resources_.clear();
+            index_.clear();
+        };
+
+    private:
+        std::vector<Key> keys_;
+        std::vector<const Resource *> resources_;
+        std::vector<std::uint32_t> index_;
+
+        template<typename LookupKey> std::size_t slot(const LookupKey &key) const {
+            std::size_t mask = index_.size() - 1;
+            std::size_t position = KeyTraits::hash(key) & mask;
+            while (index_[position] && !KeyTraits::equal(keys_[index_[position] - 1], key)) {
+                position = (position + 1) & mask;
+            }
+            return position;
+        };
+
+        void rehash(std::size_t capacity) {
+            index_.assign(capacity, 0);
+            for (std::size_t i = 0; i < keys_.size(); ++i) {
+                index_[slot(keys_[i])] = static_cast<std::uint32_t> (i + 1);
+            }
+        };
+    };
+
+    template<typename Key_, typename Resource_, typename ResourcePolicy = BasicResourcePolicy<Key_, Resource_>, typename KeyTraits = ResourceKeyTraits<Key_> > class ResourceBundle : private ResourcePolicy {
     public:
         using Key = Key_;
         using Resource = Resource_;
+        using Handle = ResourceHandle;
 
-        template<typename... Args> ResourceBundle(Args... args) : ResourcePolicy(args...) {
+        template<typename... Args> ResourceBundle(Args... args) : ResourcePolicy(args...), table_() {
         };
 
-        const Resource *operator[](Key key) const {
-            auto found = resources_.find(key);
-            if (found == resources_.end()) {
-                throw ResourceNotFoundException<Key>(key);
+        const Resource *operator[](Handle handle) const {
+            return table_.at(handle);
+        };
+
+        template<typename LookupKey> const Resource *operator[](const LookupKey &key) const {
+            return table_.at(resolve(key));
+        };
+
+        template<typename LookupKey> Handle find(const LookupKey &key) const {
+            return table_.find(key);
+        };
+
+        template<typename LookupKey> Handle resolve(const LookupKey &key) const {
+            Handle handle = table_.find(key);
+            if (handle.valid()) {
+                return handle;
             } else {
-                return found->second;
+                throw ResourceNotFoundException<Key>(Key(key));
+            }
+        };
+
+        Handle add(Key key, const Resource *resource) {
+            Handle handle;
+            const Resource *replaced = table_.insert(key, resource, handle);
+            if (replaced) {
+                ResourcePolicy::replace(replaced);
             }
+            return handle;
+        };
+
+        template<typename LookupKey> bool contains(const LookupKey &key) const {
+            return table_.find(key).valid();
         };
 
-        void add(Key key, const Resource *resource) {
-            ResourcePolicy::check(resources_, key);
-            resources_[key] = resource;
+        const Key &key(Handle handle) const {
+            return table_.key(handle);
         };
 
-        bool contains(Key key) const {
-            return resources_.find(key) != resources_.end();
+        std::size_t size() const {
+            return table_.size();
         };
-        
+
         void unloadAll(){
-            for (auto i = resources_.begin(); i != resources_.end(); ++i) {
-                ResourcePolicy::destroy(i->second);
+            for (auto resource : table_.resources()) {
+                ResourcePolicy::destroy(resource);
             }
-            resources_.clear();
+            table_.clear();
         };
 
         ~ResourceBundle() {
@@ -89,10 +273,10 @@ namespace Core {
         };
 
     private:
-        std::unordered_map<Key, const Resource *> resources_;
+        ResourceTable<Key_, Resource_, KeyTraits> table_;
 
-        ResourceBundle<Key_, Resource_, ResourcePolicy> &operator=(const ResourceBundle<Key_, Resource_, ResourcePolicy> &) = delete;
-        ResourceBundle(const ResourceBundle<Key_, Resource_, ResourcePolicy> &) = delete;
+        ResourceBundle<Key_, Resource_, ResourcePolicy, KeyTraits> &operator=(const ResourceBundle<Key_, Resource_, ResourcePolicy, KeyTraits> &) = delete;
+        ResourceBundle(const ResourceBundle<Key_, Resource_, ResourcePolicy, KeyTraits> &) = delete;
     };
 
 }
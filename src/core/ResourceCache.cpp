@@ -0,0 +1,127 @@
+#include "ResourceCache.h"
+
+using namespace Core;
+
+CachedResource::CachedResource() : cache_(), position_(), size_(), lastUse_(), resident_(), failed_() {
+}
+
+CachedResource::~CachedResource() {
+    attach(nullptr);
+}
+
+void CachedResource::attach(ResourceCache *cache) {
+    if (cache_ && resident_) {
+        cache_->remove(this);
+    }
+    cache_ = cache;
+    if (cache_ && resident_) {
+        cache_->add(this);
+    }
+}
+
+bool CachedResource::use() const {
+    CachedResource *resource = const_cast<CachedResource *> (this);
+    if (!resident_ && (failed_ || !resource->doLoad())) {
+        return false;
+    }
+    if (cache_) {
+        cache_->touch(resource);
+    }
+    return resident_;
+}
+
+bool CachedResource::resident() const {
+    return resident_;
+}
+
+std::size_t CachedResource::size() const {
+    return size_;
+}
+
+bool CachedResource::failed() const {
+    return failed_;
+}
+
+void CachedResource::loaded(std::size_t size) {
+    unloaded();
+    size_ = size;
+    resident_ = true;
+    failed_ = false;
+    if (cache_) {
+        cache_->add(this);
+    }
+}
+
+void CachedResource::failed(bool failed) {
+    failed_ = failed;
+}
+
+void CachedResource::unloaded() {
+    if (resident_ && cache_) {
+        cache_->remove(this);
+    }
+    size_ = 0;
+    resident_ = false;
+}
+
+ResourceCache::ResourceCache(std::size_t budget) : resources_(), budget_(budget), usage_(), frame_() {
+}
+
+ResourceCache::~ResourceCache() {
+    for (const CachedResource *resource : resources_) {
+        const_cast<CachedResource *> (resource)->cache_ = nullptr;
+    }
+}
+
+void ResourceCache::budget(std::size_t budget) {
+    budget_ = budget;
+    trim();
+}
+
+std::size_t ResourceCache::budget() const {
+    return budget_;
+}
+
+std::size_t ResourceCache::usage() const {
+    return usage_;
+}
+
+std::size_t ResourceCache::resident() const {
+    return resources_.size();
+}
+
+void ResourceCache::nextFrame() {
+    trim();
+    ++frame_;
+}
+
+void ResourceCache::trim() {
+    auto i = resources_.end();
+    while (usage_ > budget_ && i != resources_.begin()) {
+        --i;
+        CachedResource *resource = const_cast<CachedResource *> (*i);
+        if (resource->lastUse_ < frame_) {
+            ++i;
+            resource->doUnload();
+            resource->unloaded();
+        }
+    }
+}
+
+void ResourceCache::add(CachedResource *resource) {
+    resources_.push_front(resource);
+    resource->position_ = resources_.begin();
+    resource->lastUse_ = frame_;
+    usage_ += resource->size_;
+}
+
+void ResourceCache::remove(CachedResource *resource) {
+    resources_.erase(resource->position_);
+    usage_ -= resource->size_;
+}
+
+void ResourceCache::touch(CachedResource *resource) {
+    resources_.splice(resources_.begin(), resources_, resource->position_);
+    resource->lastUse_ = frame_;
+}
+
@@ -0,0 +1,120 @@
+/*
+ * File:   ResourceCache.h
+ * Author: hans
+ *
+ * Created on October 19, 2026, 3:10 PM
+ */
+
+#ifndef RESOURCECACHE_H
+#define	RESOURCECACHE_H
+
+#include <list>
+#include <cstddef>
+#include <cstdint>
+
+namespace Core {
+
+    class ResourceCache;
+
+    /*
+     * Resource whose data can be dropped by its cache and loaded again on the
+     * next use. Subclasses report their size through loaded() and unloaded(),
+     * and a load that cannot succeed through failed().
+     */
+    class CachedResource {
+    public:
+        CachedResource();
+
+        virtual ~CachedResource();
+
+        /*
+         * Loads the resource again if it was evicted, returns false if that
+         * failed; once failed() it is not tried again until cleared
+         */
+        bool use() const;
+
+        bool resident() const;
+
+        bool failed() const;
+
+        std::size_t size() const;
+
+        void attach(ResourceCache *cache);
+
+    protected:
+
+        void loaded(std::size_t size);
+
+        void unloaded();
+
+        void failed(bool failed);
+
+        virtual bool doLoad() = 0;
+
+        virtual void doUnload() = 0;
+
+    private:
+        ResourceCache *cache_;
+        std::list<const CachedResource *>::iterator position_;
+        std::size_t size_;
+        std::uint64_t lastUse_;
+        bool resident_;
+        bool failed_;
+
+        friend class ResourceCache;
+
+        CachedResource(const CachedResource &) = delete;
+        CachedResource &operator=(const CachedResource &) = delete;
+    };
+
+    /*
+     * Least recently used list of resident resources with a memory budget.
+     * Resources used during the current frame are never evicted.
+     * Not thread safe, resources are used on the thread owning the cache.
+     */
+    class ResourceCache {
+    public:
+        static const std::size_t DEFAULT_BUDGET = 256 * 1024 * 1024;
+
+        ResourceCache(std::size_t budget = DEFAULT_BUDGET);
+
+        ~ResourceCache();
+
+        void budget(std::size_t budget);
+
+        std::size_t budget() const;
+
+        std::size_t usage() const;
+
+        std::size_t resident() const;
+
+        /*
+         * Evicts resources not used during the ending frame until the budget
+         * is met, then starts the next frame
+         */
+        void nextFrame();
+
+        void trim();
+
+    private:
+        std::list<const CachedResource *> resources_;
+        std::size_t budget_;
+        std::size_t usage_;
+        std::uint64_t frame_;
+
+        void add(CachedResource *resource);
+
+        void remove(CachedResource *resource);
+
+        void touch(CachedResource *resource);
+
+        friend class CachedResource;
+
+        ResourceCache(const ResourceCache &) = delete;
+        ResourceCache &operator=(const ResourceCache &) = delete;
+    };
+
+}
+
+#endif	/* RESOURCECACHE_H */
+
@@ -1,11 +1,131 @@
 #include "StringBundle.h"
 
 #include "String.h"
+#include "Hash.h"
 #include "CharacterBuffer.h"
 
+#include <algorithm>
+
 using namespace Core;
 
-StringBundle::StringBundle() {
+namespace {
+
+    const char MAGIC[4] = {'S', 'P', 'S', 'B'};
+
+    const std::uint32_t VERSION = 1;
+
+    struct Header{
+        std::uint64_t stamp;
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t entryCount;
+        std::uint32_t indexSize;
+        std::uint32_t valueCount;
+        std::uint32_t keyPoolSize;
+    };
+
+    template<typename T> void writeArray(std::ostream &output, const T *data, std::size_t count) {
+        output.write(reinterpret_cast<const char *> (data), static_cast<std::streamsize> (sizeof (T) * count));
+    }
+
+}
+
+StringBundle::StringBundle() : keys_(), values_(), entries_(), index_(), file_(), keyData_(), valueData_(), entryData_(), indexData_(), entryCount_(), indexSize_() {
+}
+
+void StringBundle::sync() {
+    keyData_ = keys_.data();
+    valueData_ = values_.data();
+    entryData_ = entries_.data();
+    indexData_ = index_.data();
+    entryCount_ = entries_.size();
+    indexSize_ = index_.size();
+}
+
+void StringBundle::thaw() {
+    if (file_.opened()) {
+        const char *keyEnd = keyData_;
+        for (std::size_t i = 0; i < entryCount_; ++i) {
+            keyEnd = std::max(keyEnd, keyData_ + entryData_[i].keyOffset + entryData_[i].keyLength);
+        }
+        const Unicode::Character *valueEnd = valueData_;
+        for (std::size_t i = 0; i < entryCount_; ++i) {
+            valueEnd = std::max(valueEnd, valueData_ + entryData_[i].valueOffset + entryData_[i].valueLength);
+        }
+        keys_.assign(keyData_, keyEnd);
+        values_.assign(valueData_, valueEnd);
+        entries_.assign(entryData_, entryData_ + entryCount_);
+        index_.assign(indexData_, indexData_ + indexSize_);
+        file_.close();
+        sync();
+    }
+}
+
+template<typename Char> std::size_t StringBundle::slot(const Char *key, std::size_t length) const {
+    std::size_t mask = indexSize_ - 1;
+    std::size_t position = static_cast<std::size_t> (hash(key, length)) & mask;
+    while (indexData_[position]) {
+        const Entry &entry = entryData_[indexData_[position] - 1];
+        if (entry.keyLength == length) {
+            const char *candidate = keyData_ + entry.keyOffset;
+            std::size_t i = 0;
+            while (i < length && static_cast<unsigned char> (candidate[i]) == static_cast<std::uint32_t> (key[i])) {
+                ++i;
+            }
+            if (i == length) {
+                return position;
+            }
+        }
+        position = (position + 1) & mask;
+    }
+    return position;
+}
+
+void StringBundle::rehash(std::size_t capacity) {
+    index_.assign(capacity, 0);
+    sync();
+    for (std::size_t i = 0; i < entries_.size(); ++i) {
+        const Entry &entry = entries_[i];
+        index_[slot(keys_.data() + entry.keyOffset, entry.keyLength)] = static_cast<std::uint32_t> (i + 1);
+    }
+}
+
+template<typename Char> void StringBundle::add(const Char *keyBegin, const Char *keyEnd, const Unicode::Character *valueBegin, const Unicode::Character *valueEnd) {
+    if ((entries_.size() + 1) * 2 > index_.size()) {
+        rehash(index_.empty() ? 64 : index_.size() * 2);
+    }
+    std::size_t keyLength = static_cast<std::size_t> (keyEnd - keyBegin);
+    std::size_t position = slot(keyBegin, keyLength);
+    if (!index_[position]) {
+        Entry entry;
+        entry.keyOffset = static_cast<std::uint32_t> (keys_.size());
+        entry.keyLength = static_cast<std::uint32_t> (keyLength);
+        for (const Char *c = keyBegin; c != keyEnd; ++c) {
+            keys_.push_back(static_cast<char> (*c));
+        }
+        entries_.push_back(entry);
+        index_[position] = static_cast<std::uint32_t> (entries_.size());
+    }
+    Entry &entry = entries_[index_[position] - 1];
+    entry.valueOffset = static_cast<std::uint32_t> (values_.size());
+    entry.valueLength = static_cast<std::uint32_t> (valueEnd - valueBegin);
+    values_.insert(values_.end(), valueBegin, valueEnd);
+    sync();
+}
+
+void StringBundle::append(const char *keys, const Unicode::Character *values, const Entry *entries, std::size_t count) {
+    thaw();
+    for (std::size_t i = 0; i < count; ++i) {
+        const char *key = keys + entries[i].keyOffset;
+        const Unicode::Character *value = values + entries[i].valueOffset;
+        add(key, key + entries[i].keyLength, value, value + entries[i].valueLength);
+    }
+}
+
+void StringBundle::merge(const StringBundle &other) {
+    if (&other != this) {
+        append(other.keyData_, other.valueData_, other.entryData_, other.entryCount_);
+    }
 }
 
 const char32_t *StringBundle::parseStatement(const char32_t *current, const char32_t *end, int line) {
@@ -26,7 +146,7 @@ const char32_t *StringBundle::parseStatement(const char32_t *current, const char
         while (current != end && (!std::char_traits<char32_t>::eq(*current, '\n'))) {
             ++current;
         }
-        ResourceBundle<std::string, Unicode::String>::add(std::string{keyBegin, keyEnd}, new Unicode::String{keyEnd + 1, current});
+        add(keyBegin, keyEnd, keyEnd + 1, current);
         if (current != end) {
             ++current;
         }
@@ -38,6 +158,7 @@ const char32_t *StringBundle::parseStatement(const char32_t *current, const char
 
 void StringBundle::parse(const char32_t *buffer, std::streamsize length) {
     const char32_t *end = buffer + length;
+    values_.reserve(values_.size() + static_cast<std::size_t> (length));
     int line{0};
     while (buffer != end) {
         buffer = parseStatement(buffer, end, line);
@@ -49,6 +170,7 @@ void StringBundle::load(std::istream &input) {
     if (input.bad()) {
         throw ResourceException("unable to read resources from stream");
     }
+    thaw();
     UTF8ToUTF32InputBuffer<char32_t, char> buffer;
     if (buffer.read(input) == BufferState::OK) {//TODO:input.eof()){
         parse(buffer.begin(), buffer.length());
@@ -57,7 +179,139 @@ void StringBundle::load(std::istream &input) {
     }
 }
 
-StringBundle::~StringBundle() {
+bool StringBundle::find(const char *key, std::size_t length, Value &value) const {
+    if (indexSize_ == 0) {
+        return false;
+    }
+    std::uint32_t found = indexData_[slot(key, length)];
+    if (found) {
+        const Entry &entry = entryData_[found - 1];
+        const Unicode::Character *begin = valueData_ + entry.valueOffset;
+        value = Value{begin, begin + entry.valueLength};
+        return true;
+    } else {
+        return false;
+    }
+}
+
+bool StringBundle::contains(const char *key, std::size_t length) const {
+    Value value;
+    return find(key, length, value);
+}
+
+bool StringBundle::contains(const std::string &key) const {
+    return contains(key.data(), key.length());
+}
+
+StringBundle::Value StringBundle::get(const char *key, std::size_t length) const {
+    Value value;
+    if (find(key, length, value)) {
+        return value;
+    } else {
+        throw ResourceNotFoundException<std::string>(std::string{key, length});
+    }
+}
+
+Unicode::String StringBundle::operator[](const std::string &key) const {
+    Value value = get(key.data(), key.length());
+    return Unicode::String{value.begin(), value.end()};
+}
+
+std::size_t StringBundle::size() const {
+    return entryCount_;
+}
+
+void StringBundle::unloadAll() {
+    file_.close();
+    keys_.clear();
+    values_.clear();
+    entries_.clear();
+    index_.clear();
+    sync();
+}
+
+void StringBundle::write(std::ostream &output, std::uint64_t stamp) const {
+    std::vector<Entry> entries{entryData_, entryData_ + entryCount_};
+    std::vector<Unicode::Character> values;
+    std::size_t keyPoolSize = 0;
+    for (Entry &entry : entries) {
+        const Unicode::Character *value = valueData_ + entry.valueOffset;
+        entry.valueOffset = static_cast<std::uint32_t> (values.size());
+        values.insert(values.end(), value, value + entry.valueLength);
+        keyPoolSize = std::max<std::size_t>(keyPoolSize, entry.keyOffset + entry.keyLength);
+    }
+    Header header;
+    header.stamp = stamp;
+    std::copy(MAGIC, MAGIC + sizeof (MAGIC), header.magic);
+    header.version = VERSION;
+    header.entryCount = static_cast<std::uint32_t> (entries.size());
+    header.indexSize = static_cast<std::uint32_t> (indexSize_);
+    header.valueCount = static_cast<std::uint32_t> (values.size());
+    header.keyPoolSize = static_cast<std::uint32_t> (keyPoolSize);
+    writeArray(output, &header, 1);
+    writeArray(output, indexData_, indexSize_);
+    writeArray(output, entries.data(), entries.size());
+    writeArray(output, values.data(), values.size());
+    writeArray(output, keyData_, keyPoolSize);
+    if (!output.good()) {
+        throw ResourceException("unable to write string bundle");
+    }
 }
 
+bool StringBundle::map(const Path &path, std::uint64_t stamp) {
+    MappedFile file;
+    if (!file.open(path) || file.size() < sizeof (Header)) {
+        return false;
+    }
+    const Header *header = reinterpret_cast<const Header *> (file.data());
+    std::size_t expected = sizeof (Header)
+            + sizeof (std::uint32_t) * header->indexSize
+            + sizeof (Entry) * header->entryCount
+            + sizeof (Unicode::Character) * header->valueCount
+            + header->keyPoolSize;
+    // lookups probe until an empty slot, so one has to be left
+    if (header->stamp != stamp || !std::equal(MAGIC, MAGIC + sizeof (MAGIC), header->magic) || header->version != VERSION || file.size() != expected
+            || (header->indexSize & (header->indexSize - 1)) != 0 || (header->indexSize != 0 && header->entryCount >= header->indexSize)
+            || (header->indexSize == 0 && header->entryCount != 0)) {
+        return false;
+    }
+    const char *data = file.data() + sizeof (Header);
+    const std::uint32_t *index = reinterpret_cast<const std::uint32_t *> (data);
+    const Entry *entries = reinterpret_cast<const Entry *> (index + header->indexSize);
+    const Unicode::Character *values = reinterpret_cast<const Unicode::Character *> (entries + header->entryCount);
+    const char *keys = reinterpret_cast<const char *> (values + header->valueCount);
+    for (std::size_t i = 0; i < header->entryCount; ++i) {
+        if (static_cast<std::size_t> (entries[i].keyOffset) + entries[i].keyLength > header->keyPoolSize
+                || static_cast<std::size_t> (entries[i].valueOffset) + entries[i].valueLength > header->valueCount) {
+            return false;
+        }
+    }
+    std::size_t used = 0;
+    for (std::size_t i = 0; i < header->indexSize; ++i) {
+        if (index[i] > header->entryCount) {
+            return false;
+        } else if (index[i]) {
+            ++used;
+        }
+    }
+    if (used != header->entryCount) {
+        return false;
+    }
+    if (entryCount_ != 0) {
+        append(keys, values, entries, header->entryCount);
+        return true;
+    }
+    unloadAll();
+    indexData_ = index;
+    entryData_ = entries;
+    valueData_ = values;
+    keyData_ = keys;
+    entryCount_ = header->entryCount;
+    indexSize_ = header->indexSize;
+    file_.swap(file);
+    return true;
+}
+
+StringBundle::~StringBundle() {
+}
 
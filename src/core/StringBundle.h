@@ -1,4 +1,4 @@
-/* 
+/*
  * File:   StringBundle.h
  * Author: hans
  *
@@ -10,26 +10,101 @@
 
 #include "Resource.h"
 #include "Path.h"
+#include "Parser.h"
 #include "Unicode.h"
+#include "MappedFile.h"
 
 #include <string>
 #include <locale>
+#include <vector>
+#include <cstdint>
 
 namespace Core{
-    
-    class StringBundle : public ResourceBundle<std::string, std::u32string>{
+
+    /*
+     * Labels are stored in pools: all keys in one character pool, all values in
+     * one UTF-32 arena and an open addressing index of entry numbers.
+     * Redefining a key points its entry to the new value, the old value stays
+     * in the arena until the bundle is unloaded or written.
+     *
+     * A bundle can be written in a binary form and mapped back later; a mapped
+     * bundle is read only until the next load, which copies it into memory first.
+     * Like loading, mapping into a bundle that already holds labels adds to them.
+     */
+    class StringBundle{
     public:
+        using Value = Range<const Unicode::Character *>;
+
         StringBundle();
         ~StringBundle();
-        
+
         void load(std::istream &input);
-        
+
+        void write(std::ostream &output, std::uint64_t stamp) const;
+
+        /*
+         * False, leaving the bundle as it is, if the file is not a valid bundle
+         * written with this stamp
+         */
+        bool map(const Path &path, std::uint64_t stamp);
+
+        /*
+         * Adds the labels of other, redefining keys both hold
+         */
+        void merge(const StringBundle &other);
+
+        bool contains(const std::string &key) const;
+
+        bool contains(const char *key, std::size_t length) const;
+
+        bool find(const char *key, std::size_t length, Value &value) const;
+
+        Value get(const char *key, std::size_t length) const;
+
+        Unicode::String operator[](const std::string &key) const;
+
+        std::size_t size() const;
+
+        void unloadAll();
+
     private:
 
+        struct Entry{
+            std::uint32_t keyOffset;
+            std::uint32_t keyLength;
+            std::uint32_t valueOffset;
+            std::uint32_t valueLength;
+        };
+
+        std::vector<char> keys_;
+        std::vector<Unicode::Character> values_;
+        std::vector<Entry> entries_;
+        std::vector<std::uint32_t> index_;
+
+        MappedFile file_;
+        const char *keyData_;
+        const Unicode::Character *valueData_;
+        const Entry *entryData_;
+        const std::uint32_t *indexData_;
+        std::size_t entryCount_;
+        std::size_t indexSize_;
+
+        void sync();
+
+        void thaw();
+
         void parse(const char32_t *buffer, std::streamsize length);
-        
+
         const char32_t *parseStatement(const char32_t *begin, const char32_t *end, int line);
-        
+
+        template<typename Char> std::size_t slot(const Char *key, std::size_t length) const;
+
+        template<typename Char> void add(const Char *keyBegin, const Char *keyEnd, const Unicode::Character *valueBegin, const Unicode::Character *valueEnd);
+
+        void append(const char *keys, const Unicode::Character *values, const Entry *entries, std::size_t count);
+
+        void rehash(std::size_t capacity);
+
         StringBundle(const StringBundle &) = delete;
         StringBundle &operator=(const StringBundle &) = delete;
     };
@@ -0,0 +1,172 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+using namespace Core;
+
+namespace {
+
+    // the pool and queue of the worker running on this thread
+    thread_local const ThreadPool *currentPool = nullptr;
+    thread_local unsigned currentQueue = 0;
+
+}
+
+ThreadPool::ThreadPool(unsigned threadCount) : threads_(), queues_(), mutex_(), available_(), finished_(), queued_(0), nextQueue_(0), pending_(), error_(), stopping_() {
+    if (threadCount == 0) {
+        threadCount = std::max(1U, std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        queues_.emplace_back(new Queue{});
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        threads_.emplace_back(&ThreadPool::work, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        stopping_ = true;
+    }
+    available_.notify_all();
+    for (std::thread &thread : threads_) {
+        thread.join();
+    }
+}
+
+void ThreadPool::submit(Task task) {
+    unsigned index = currentPool == this ? currentQueue : nextQueue_++ % size();
+    {
+        // counted under the pool mutex so sleeping workers never miss it
+        std::lock_guard<std::mutex> lock{mutex_};
+        ++pending_;
+        ++queued_;
+    }
+    {
+        Queue &queue = *queues_[index];
+        std::lock_guard<std::mutex> lock{queue.mutex};
+        queue.tasks.push_back(std::move(task));
+    }
+    available_.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock{mutex_};
+    finished_.wait(lock, [this]() {
+        return pending_ == 0;
+    });
+    if (error_) {
+        std::exception_ptr error{error_};
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::parallel(std::size_t count, const std::function<void(std::size_t)> &body) {
+    if (count == 0) {
+        return;
+    }
+    struct State {
+        std::atomic<std::size_t> next;
+        std::atomic<std::size_t> done;
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::exception_ptr error;
+    };
+    // helpers starting after the last index was taken only touch the state
+    std::shared_ptr<State> state{new State{}};
+    state->next = 0;
+    state->done = 0;
+    const std::function<void(std::size_t)> *function = &body;
+    Task drain = [state, function, count]() {
+        for (std::size_t i = state->next++; i < count; i = state->next++) {
+            try {
+                (*function)(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock{state->mutex};
+                if (!state->error) {
+                    state->error = std::current_exception();
+                }
+            }
+            if (++state->done == count) {
+                std::lock_guard<std::mutex> lock{state->mutex};
+                state->finished.notify_all();
+            }
+        }
+    };
+    std::size_t helpers = std::min<std::size_t>(count - 1, size());
+    for (std::size_t i = 0; i < helpers; ++i) {
+        submit(drain);
+    }
+    drain();
+    std::unique_lock<std::mutex> lock{state->mutex};
+    state->finished.wait(lock, [&state, count]() {
+        return state->done == count;
+    });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+unsigned ThreadPool::size() const {
+    return static_cast<unsigned> (queues_.size());
+}
+
+bool ThreadPool::take(unsigned index, Task &task) {
+    const unsigned count = size();
+    for (unsigned i = 0; i < count; ++i) {
+        Queue &queue = *queues_[(index + i) % count];
+        std::lock_guard<std::mutex> lock{queue.mutex};
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        if (i == 0) {
+            // own queue: newest first, its data is most likely still cached
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        --queued_;
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::run(Task &task) {
+    std::exception_ptr error;
+    try {
+        task();
+    } catch (...) {
+        error = std::current_exception();
+    }
+    task = nullptr;
+    std::lock_guard<std::mutex> lock{mutex_};
+    if (error && !error_) {
+        error_ = error;
+    }
+    if (--pending_ == 0) {
+        finished_.notify_all();
+    }
+}
+
+void ThreadPool::work(unsigned index) {
+    currentPool = this;
+    currentQueue = index;
+    Task task;
+    while (true) {
+        if (take(index, task)) {
+            run(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock{mutex_};
+        available_.wait(lock, [this]() {
+            return stopping_ || queued_ > 0;
+        });
+        if (stopping_ && queued_ == 0) {
+            return;
+        }
+    }
+}
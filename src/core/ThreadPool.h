@@ -0,0 +1,89 @@
+/*
+ * File:   ThreadPool.h
+ * Author: hans
+ *
+ * Created on October 19, 2026, 7:20 PM
+ */
+
+#ifndef THREADPOOL_H
+#define	THREADPOOL_H
+
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <exception>
+
+namespace Core {
+
+    /*
+     * Fixed set of worker threads with a task queue each. Tasks submitted by a
+     * worker go to its own queue and are run newest first, idle workers steal
+     * the oldest tasks of the others; tasks from other threads are spread over
+     * the queues.
+     */
+    class ThreadPool {
+    public:
+        using Task = std::function<void()>;
+
+        /*
+         * Starts one thread per hardware thread for 0
+         */
+        ThreadPool(unsigned threadCount = 0);
+
+        ~ThreadPool();
+
+        void submit(Task task);
+
+        /*
+         * Blocks until every task submitted so far has run, then rethrows the
+         * first exception a task threw
+         */
+        void wait();
+
+        /*
+         * Runs body for every index below count on the workers and the calling
+         * thread, returns when all have run and rethrows the first exception a
+         * call threw. Does not wait for other tasks, so it may be called from
+         * within a task.
+         */
+        void parallel(std::size_t count, const std::function<void(std::size_t)> &body);
+
+        unsigned size() const;
+
+    private:
+
+        struct Queue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        std::vector<std::thread> threads_;
+        std::vector<std::unique_ptr<Queue> > queues_;
+        std::mutex mutex_;
+        std::condition_variable available_;
+        std::condition_variable finished_;
+        std::atomic<std::size_t> queued_;
+        std::atomic<unsigned> nextQueue_;
+        std::size_t pending_;
+        std::exception_ptr error_;
+        bool stopping_;
+
+        void work(unsigned index);
+
+        bool take(unsigned index, Task &task);
+
+        void run(Task &task);
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+    };
+
+}
+
+#endif	/* THREADPOOL_H */
+
@@ -0,0 +1,67 @@
+/*
+ * File:   TripleBuffer.h
+ * Author: hans
+ *
+ * Created on October 20, 2026, 11:30 AM
+ */
+
+#ifndef TRIPLEBUFFER_H
+#define	TRIPLEBUFFER_H
+
+#include <atomic>
+
+namespace Core {
+
+    /*
+     * Hands values from one writing to one reading thread without locks or
+     * waiting. The writer fills back() and publishes it, the reader takes the
+     * newest published value with acquire() and reads it through front()
+     * until the next acquire; values published in between are skipped.
+     * Buffers are reused, so containers inside keep their capacity.
+     */
+    template<typename T> class TripleBuffer {
+    public:
+
+        TripleBuffer() : buffers_(), middle_(1), back_(0), front_(2) {
+        };
+
+        T &back() {
+            return buffers_[back_];
+        };
+
+        void publish() {
+            back_ = middle_.exchange(back_ | FRESH, std::memory_order_acq_rel) & INDEX;
+        };
+
+        /*
+         * Returns whether a newer value than front() was taken
+         */
+        bool acquire() {
+            if (!(middle_.load(std::memory_order_acquire) & FRESH)) {
+                return false;
+            }
+            front_ = middle_.exchange(front_, std::memory_order_acq_rel) & INDEX;
+            return true;
+        };
+
+        const T &front() const {
+            return buffers_[front_];
+        };
+
+    private:
+        static const unsigned INDEX = 3;
+        static const unsigned FRESH = 4;
+
+        T buffers_[3];
+        std::atomic<unsigned> middle_;
+        unsigned back_;
+        unsigned front_;
+
+        TripleBuffer(const TripleBuffer &) = delete;
+        TripleBuffer &operator=(const TripleBuffer &) = delete;
+    };
+
+}
+
+#endif	/* TRIPLEBUFFER_H */
+
@@ -0,0 +1,176 @@
+#include "VirtualFileSystem.h"
+
+#include <algorithm>
+
+using namespace Core;
+
+MemoryBuffer::MemoryBuffer() : std::streambuf() {
+}
+
+void MemoryBuffer::assign(const char *data, std::size_t size) {
+    char *begin = const_cast<char *> (data);
+    setg(begin, begin, begin + size);
+}
+
+MemoryBuffer::pos_type MemoryBuffer::seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode mode) {
+    if (!(mode & std::ios_base::in)) {
+        return pos_type(off_type(-1));
+    }
+    off_type position = offset;
+    if (direction == std::ios_base::cur) {
+        position += gptr() - eback();
+    } else if (direction == std::ios_base::end) {
+        position += egptr() - eback();
+    }
+    if (position < 0 || position > egptr() - eback()) {
+        return pos_type(off_type(-1));
+    }
+    setg(eback(), eback() + position, egptr());
+    return pos_type(position);
+}
+
+MemoryBuffer::pos_type MemoryBuffer::seekpos(pos_type position, std::ios_base::openmode mode) {
+    return seekoff(off_type(position), std::ios_base::beg, mode);
+}
+
+FileInput::FileInput() : std::istream(nullptr), file_(), memory_(), buffer_(), data_(), size_() {
+}
+
+bool FileInput::openFile(const std::string &path) {
+    if (file_.open(path.c_str(), std::ios::in | std::ios::binary)) {
+        rdbuf(&file_);
+        clear();
+        return true;
+    } else {
+        setstate(std::ios::failbit);
+        return false;
+    }
+}
+
+bool FileInput::openMemory(const char *data, std::size_t size) {
+    data_ = data;
+    size_ = size;
+    memory_.assign(data, size);
+    rdbuf(&memory_);
+    clear();
+    return true;
+}
+
+std::string &FileInput::buffer() {
+    return buffer_;
+}
+
+bool FileInput::inMemory() const {
+    return rdbuf() == &memory_;
+}
+
+const char *FileInput::data() const {
+    return data_;
+}
+
+std::size_t FileInput::size() const {
+    return size_;
+}
+
+VirtualFileSystem &VirtualFileSystem::global() {
+    static VirtualFileSystem fileSystem;
+    return fileSystem;
+}
+
+VirtualFileSystem::VirtualFileSystem() : mounts_(), mutex_() {
+}
+
+bool VirtualFileSystem::mount(const Path &mountPoint, const Path &pack) {
+    Mount mount{mountPoint.data(), std::unique_ptr<PackFile>{new PackFile{}}};
+    if (!mount.pack->open(pack)) {
+        return false;
+    }
+    unmount(mountPoint);
+    std::lock_guard<std::mutex> lock{mutex_};
+    mounts_.push_back(std::move(mount));
+    return true;
+}
+
+void VirtualFileSystem::unmount(const Path &mountPoint) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    for (auto i = mounts_.begin(); i != mounts_.end(); ++i) {
+        if (i->path == mountPoint.data()) {
+            mounts_.erase(i);
+            return;
+        }
+    }
+}
+
+std::list<Path> VirtualFileSystem::mountPoints() const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    std::list<Path> result;
+    for (const Mount &mount : mounts_) {
+        result.push_back(Path{mount.path});
+    }
+    return result;
+}
+
+const PackFile *VirtualFileSystem::find(const std::string &path, std::string &name) const {
+    for (const Mount &mount : mounts_) {
+        if (path.compare(0, mount.path.length(), mount.path) == 0) {
+            if (path.length() == mount.path.length()) {
+                name.clear();
+                return mount.pack.get();
+            } else if (path[mount.path.length()] == Path::SEPARATOR) {
+                name = path.substr(mount.path.length() + 1);
+                if (Path::SEPARATOR != '/') {
+                    std::replace(name.begin(), name.end(), Path::SEPARATOR, '/');
+                }
+                return mount.pack.get();
+            }
+        }
+    }
+    return nullptr;
+}
+
+bool VirtualFileSystem::status(const std::string &path, FileStatus &status) const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    std::string name;
+    const PackFile *pack = find(path, name);
+    if (pack) {
+        status = pack->status(name);
+        return true;
+    } else {
+        return false;
+    }
+}
+
+bool VirtualFileSystem::children(const std::string &path, bool foldersOnly, std::list<Path> &children) const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    std::string name;
+    const PackFile *pack = find(path, name);
+    if (pack) {
+        children.clear();
+        Path parent{path};
+        for (const std::string &child : pack->children(name, foldersOnly)) {
+            children.push_back(Path{parent, child});
+        }
+        return true;
+    } else {
+        return false;
+    }
+}
+
+bool VirtualFileSystem::open(const std::string &path, FileInput &input) const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    std::string name;
+    const PackFile *pack = find(path, name);
+    if (pack) {
+        const char *data;
+        std::size_t size;
+        if (pack->read(name, data, size, input.buffer())) {
+            return input.openMemory(data, size);
+        } else {
+            input.setstate(std::ios::failbit);
+            return false;
+        }
+    } else {
+        return false;
+    }
+}
+
@@ -0,0 +1,111 @@
+/*
+ * File:   VirtualFileSystem.h
+ * Author: hans
+ *
+ * Created on October 19, 2026, 6:15 PM
+ */
+
+#ifndef VIRTUALFILESYSTEM_H
+#define	VIRTUALFILESYSTEM_H
+
+#include "Path.h"
+#include "PackFile.h"
+
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <istream>
+#include <fstream>
+
+namespace Core {
+
+    /*
+     * Stream buffer reading a block of memory
+     */
+    class MemoryBuffer : public std::streambuf {
+    public:
+        MemoryBuffer();
+
+        void assign(const char *data, std::size_t size);
+
+    protected:
+        pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode mode);
+
+        pos_type seekpos(pos_type position, std::ios_base::openmode mode);
+    };
+
+    /*
+     * Input stream over a loose file or over a file inside a mounted pack;
+     * for the latter the whole contents are available through data()
+     */
+    class FileInput : public std::istream {
+    public:
+        FileInput();
+
+        bool openFile(const std::string &path);
+
+        bool openMemory(const char *data, std::size_t size);
+
+        std::string &buffer();
+
+        bool inMemory() const;
+
+        const char *data() const;
+
+        std::size_t size() const;
+
+    private:
+        std::filebuf file_;
+        MemoryBuffer memory_;
+        std::string buffer_;
+        const char *data_;
+        std::size_t size_;
+
+        FileInput(const FileInput &) = delete;
+        FileInput &operator=(const FileInput &) = delete;
+    };
+
+    /*
+     * Pack files mounted on folder paths. Path serves files below a mount
+     * point from the pack, so a packed module reads like a loose one.
+     */
+    class VirtualFileSystem {
+    public:
+        static VirtualFileSystem &global();
+
+        VirtualFileSystem();
+
+        bool mount(const Path &mountPoint, const Path &pack);
+
+        void unmount(const Path &mountPoint);
+
+        std::list<Path> mountPoints() const;
+
+        bool status(const std::string &path, FileStatus &status) const;
+
+        bool children(const std::string &path, bool foldersOnly, std::list<Path> &children) const;
+
+        bool open(const std::string &path, FileInput &input) const;
+
+    private:
+
+        struct Mount {
+            std::string path;
+            std::unique_ptr<PackFile> pack;
+        };
+
+        std::vector<Mount> mounts_;
+        mutable std::mutex mutex_;
+
+        const PackFile *find(const std::string &path, std::string &name) const;
+
+        VirtualFileSystem(const VirtualFileSystem &) = delete;
+        VirtualFileSystem &operator=(const VirtualFileSystem &) = delete;
+    };
+
+}
+
+#endif	/* VIRTUALFILESYSTEM_H */
+
@@ -325,7 +325,7 @@ namespace JSON {
             iterator_++;
             delete node_;
             node_ = new Node{tree_, *iterator_};
-            *this;
+            return *this;
         };
         
         bool operator==(const ArrayIterator<JSONTraits, TypePolicy> &i) const{
@@ -0,0 +1,255 @@
+#include "BodyStore.h"
+
+#include <utility>
+
+using namespace Game;
+
+namespace {
+
+    template<typename T> void moveRow(std::vector<T> &values, std::size_t to){
+        if(to + 1 != values.size()){
+            values[to] = std::move(values.back());
+        }
+        values.pop_back();
+    }
+
+}
+
+const BodyStore::Id BodyStore::NONE = 0xFFFFFFFF;
+
+BodyStore::BodyStore() : entries_(), freeIds_(), systems_(), tables_(), engine_(new OrbitEngine{}){
+}
+
+BodyStore::Id BodyStore::allocate(Kind kind, Id row){
+    Id id;
+    if(freeIds_.empty()){
+        id = static_cast<Id>(entries_.size());
+        entries_.push_back(Entry{kind, row, NONE, NONE, NONE});
+    }else{
+        id = freeIds_.back();
+        freeIds_.pop_back();
+        entries_[id] = Entry{kind, row, NONE, NONE, NONE};
+    }
+    return id;
+}
+
+BodyStore::Bodies &BodyStore::table(Kind kind){
+    return tables_[static_cast<int>(kind) - 1];
+}
+
+const BodyStore::Bodies &BodyStore::table(Kind kind) const{
+    return tables_[static_cast<int>(kind) - 1];
+}
+
+BodyStore::Id BodyStore::addSystem(std::u32string name, Position position){
+    OrbitEngine::Id orbit = engine_->addRoot(position);
+    Id id = allocate(Kind::SYSTEM, static_cast<Id>(systems_.ids.size()));
+    systems_.ids.push_back(id);
+    systems_.names.push_back(std::move(name));
+    systems_.orbits.push_back(orbit);
+    return id;
+}
+
+BodyStore::Id BodyStore::addBody(Kind kind, Id parent, std::u32string name, Scalar radius, const OrbitalBodyResource *resource, const Orbit &orbit){
+    if(!contains(parent)){
+        return NONE;
+    }
+    Id system = this->system(parent);
+    OrbitEngine::Id id = orbit.insert(*engine_, this->orbit(parent));
+    if(id == OrbitEngine::NONE){
+        return NONE;
+    }
+    Bodies &bodies = table(kind);
+    Id entity = allocate(kind, static_cast<Id>(bodies.ids.size()));
+    bodies.ids.push_back(entity);
+    bodies.systems.push_back(system);
+    bodies.parents.push_back(parent);
+    bodies.names.push_back(std::move(name));
+    bodies.radii.push_back(radius);
+    bodies.resources.push_back(resource);
+    bodies.orbits.push_back(id);
+    Entry &parentEntry = entries_[parent];
+    if(parentEntry.firstChild != NONE){
+        entries_[parentEntry.firstChild].previousSibling = entity;
+    }
+    entries_[entity].nextSibling = parentEntry.firstChild;
+    parentEntry.firstChild = entity;
+    return entity;
+}
+
+BodyStore::Id BodyStore::addStar(Id parent, std::u32string name, Scalar radius, const OrbitalBodyResource *resource, const Orbit &orbit){
+    return addBody(Kind::STAR, parent, std::move(name), radius, resource, orbit);
+}
+
+BodyStore::Id BodyStore::addPlanet(Id parent, std::u32string name, Scalar radius, const OrbitalBodyResource *resource, const Orbit &orbit){
+    return addBody(Kind::PLANET, parent, std::move(name), radius, resource, orbit);
+}
+
+BodyStore::Id BodyStore::addBarycenter(Id parent, const Orbit &orbit){
+    return addBody(Kind::BARYCENTER, parent, std::u32string{}, 0., nullptr, orbit);
+}
+
+void BodyStore::erase(Id id){
+    Entry entry = entries_[id];
+    if(entry.kind == Kind::SYSTEM){
+        Systems &systems = systems_;
+        entries_[systems.ids.back()].row = entry.row;
+        moveRow(systems.ids, entry.row);
+        moveRow(systems.names, entry.row);
+        moveRow(systems.orbits, entry.row);
+    }else{
+        Id parent = table(entry.kind).parents[entry.row];
+        if(entry.previousSibling != NONE){
+            entries_[entry.previousSibling].nextSibling = entry.nextSibling;
+        }else if(contains(parent)){
+            entries_[parent].firstChild = entry.nextSibling;
+        }
+        if(entry.nextSibling != NONE){
+            entries_[entry.nextSibling].previousSibling = entry.previousSibling;
+        }
+        Bodies &bodies = table(entry.kind);
+        entries_[bodies.ids.back()].row = entry.row;
+        moveRow(bodies.ids, entry.row);
+        moveRow(bodies.systems, entry.row);
+        moveRow(bodies.parents, entry.row);
+        moveRow(bodies.names, entry.row);
+        moveRow(bodies.radii, entry.row);
+        moveRow(bodies.resources, entry.row);
+        moveRow(bodies.orbits, entry.row);
+    }
+    entries_[id] = Entry{Kind::SYSTEM, NONE, NONE, NONE, NONE};
+    freeIds_.push_back(id);
+}
+
+void BodyStore::remove(Id id){
+    if(!contains(id)){
+        return;
+    }
+    std::vector<Id> removed;
+    subtree(id, removed);
+    for(Id body : removed){
+        engine_->remove(orbit(body));
+    }
+    // children go before their parents
+    for(auto body = removed.rbegin(); body != removed.rend(); ++body){
+        erase(*body);
+    }
+}
+
+void BodyStore::clear(){
+    // the engine stays, whoever simulates it keeps a valid one
+    for(Id id = 0; id < entries_.size(); ++id){
+        if(contains(id)){
+            engine_->remove(orbit(id));
+        }
+    }
+    entries_.clear();
+    freeIds_.clear();
+    systems_ = Systems{};
+    for(Bodies &bodies : tables_){
+        bodies = Bodies{};
+    }
+}
+
+void BodyStore::reserve(Kind kind, std::size_t count){
+    entries_.reserve(entries_.size() + count);
+    if(kind == Kind::SYSTEM){
+        std::size_t size = systems_.ids.size() + count;
+        systems_.ids.reserve(size);
+        systems_.names.reserve(size);
+        systems_.orbits.reserve(size);
+    }else{
+        Bodies &bodies = table(kind);
+        std::size_t size = bodies.ids.size() + count;
+        bodies.ids.reserve(size);
+        bodies.systems.reserve(size);
+        bodies.parents.reserve(size);
+        bodies.names.reserve(size);
+        bodies.radii.reserve(size);
+        bodies.resources.reserve(size);
+        bodies.orbits.reserve(size);
+    }
+}
+
+bool BodyStore::contains(Id id) const{
+    return id < entries_.size() && entries_[id].row != NONE;
+}
+
+BodyStore::Kind BodyStore::kind(Id id) const{
+    return entries_[id].kind;
+}
+
+BodyStore::Id BodyStore::system(Id id) const{
+    const Entry &entry = entries_[id];
+    return entry.kind == Kind::SYSTEM ? id : table(entry.kind).systems[entry.row];
+}
+
+BodyStore::Id BodyStore::parent(Id id) const{
+    const Entry &entry = entries_[id];
+    return entry.kind == Kind::SYSTEM ? NONE : table(entry.kind).parents[entry.row];
+}
+
+BodyStore::Id BodyStore::firstChild(Id id) const{
+    return entries_[id].firstChild;
+}
+
+BodyStore::Id BodyStore::nextSibling(Id id) const{
+    return entries_[id].nextSibling;
+}
+
+BodyStore::Id BodyStore::next(Id id, Id root) const{
+    if(entries_[id].firstChild != NONE){
+        return entries_[id].firstChild;
+    }
+    while(id != root && entries_[id].nextSibling == NONE){
+        id = parent(id);
+    }
+    return id == root ? NONE : entries_[id].nextSibling;
+}
+
+void BodyStore::subtree(Id id, std::vector<Id> &ids) const{
+    ids.push_back(id);
+    for(Id body = firstChild(id); body != NONE; body = next(body, id)){
+        ids.push_back(body);
+    }
+}
+
+const std::u32string &BodyStore::name(Id id) const{
+    const Entry &entry = entries_[id];
+    return entry.kind == Kind::SYSTEM ? systems_.names[entry.row] : table(entry.kind).names[entry.row];
+}
+
+Scalar BodyStore::radius(Id id) const{
+    const Entry &entry = entries_[id];
+    return entry.kind == Kind::SYSTEM ? 0. : table(entry.kind).radii[entry.row];
+}
+
+const OrbitalBodyResource *BodyStore::resource(Id id) const{
+    const Entry &entry = entries_[id];
+    return entry.kind == Kind::SYSTEM ? nullptr : table(entry.kind).resources[entry.row];
+}
+
+OrbitEngine &BodyStore::engine() const{
+    return *engine_;
+}
+
+OrbitEngine::Id BodyStore::orbit(Id id) const{
+    const Entry &entry = entries_[id];
+    return entry.kind == Kind::SYSTEM ? systems_.orbits[entry.row] : table(entry.kind).orbits[entry.row];
+}
+
+Position BodyStore::position(Id id) const{
+    return engine_->position(orbit(id));
+}
+
+const BodyStore::Systems &BodyStore::systems() const{
+    return systems_;
+}
+
+const BodyStore::Bodies &BodyStore::bodies(Kind kind) const{
+    return table(kind);
+}
+
+std::size_t BodyStore::size() const{
+    return entries_.size() - freeIds_.size();
+}
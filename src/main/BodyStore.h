@@ -0,0 +1,173 @@
+/*
+ * File:   BodyStore.h
+ * Author: hans
+ *
+ * Created on October 20, 2026, 5:30 PM
+ */
+
+#ifndef BODYSTORE_H
+#define	BODYSTORE_H
+
+#include "Orbit.h"
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+
+namespace Game{
+
+    class OrbitalBodyResource;
+
+    /*
+     * Star systems and the bodies in them as ids, their components stored in
+     * one table per kind of entity with a contiguous array per component, so
+     * walking all entities of a kind walks memory linearly. Rows move when
+     * others are removed, ids stay valid until removed. Every entity keeps a
+     * list of what orbits it, so a system or body is walked without looking
+     * at any other.
+     *
+     * The orbits of all systems are in one engine of the store, every
+     * system being a root of it; positions live there.
+     */
+    class BodyStore{
+    public:
+        using Id = std::uint32_t;
+
+        static const Id NONE;
+
+        enum class Kind : std::uint8_t{
+            SYSTEM, STAR, PLANET,
+            // invisible center bodies orbit, like the barycenter of a binary
+            BARYCENTER
+        };
+
+        struct Systems{
+            std::vector<Id> ids;
+            std::vector<std::u32string> names;
+            std::vector<OrbitEngine::Id> orbits;
+        };
+
+        struct Bodies{
+            std::vector<Id> ids;
+            std::vector<Id> systems;
+            std::vector<Id> parents;
+            std::vector<std::u32string> names;
+            std::vector<Scalar> radii;
+            std::vector<const OrbitalBodyResource *> resources;
+            std::vector<OrbitEngine::Id> orbits;
+        };
+
+        BodyStore();
+
+        Id addSystem(std::u32string name, Position position);
+
+        /*
+         * Adds a body on orbit around parent, a system or another body of
+         * it; fails if the engine rejects the orbit
+         */
+        Id addStar(Id parent, std::u32string name, Scalar radius, const OrbitalBodyResource *resource, const Orbit &orbit);
+
+        Id addPlanet(Id parent, std::u32string name, Scalar radius, const OrbitalBodyResource *resource, const Orbit &orbit);
+
+        Id addBarycenter(Id parent, const Orbit &orbit);
+
+        /*
+         * Removes the entity and everything orbiting it
+         */
+        void remove(Id id);
+
+        void clear();
+
+        /*
+         * Makes room for count more entities of a kind
+         */
+        void reserve(Kind kind, std::size_t count);
+
+        bool contains(Id id) const;
+
+        Kind kind(Id id) const;
+
+        /*
+         * The system of a body, a system itself
+         */
+        Id system(Id id) const;
+
+        /*
+         * What a body orbits, NONE for systems
+         */
+        Id parent(Id id) const;
+
+        /*
+         * What orbits an entity directly, NONE at the end of the list
+         */
+        Id firstChild(Id id) const;
+
+        Id nextSibling(Id id) const;
+
+        /*
+         * Entity after id in a depth first walk of the entities orbiting
+         * root, NONE after the last; start with firstChild(root)
+         */
+        Id next(Id id, Id root) const;
+
+        /*
+         * Appends id and everything orbiting it, each before what orbits it
+         */
+        void subtree(Id id, std::vector<Id> &ids) const;
+
+        const std::u32string &name(Id id) const;
+
+        Scalar radius(Id id) const;
+
+        const OrbitalBodyResource *resource(Id id) const;
+
+        OrbitEngine &engine() const;
+
+        OrbitEngine::Id orbit(Id id) const;
+
+        Position position(Id id) const;
+
+        const Systems &systems() const;
+
+        /*
+         * The table of a kind of body, not of systems
+         */
+        const Bodies &bodies(Kind kind) const;
+
+        std::size_t size() const;
+
+    private:
+
+        struct Entry{
+            Kind kind;
+            Id row;
+            Id firstChild;
+            Id nextSibling;
+            Id previousSibling;
+        };
+
+        std::vector<Entry> entries_;
+        std::vector<Id> freeIds_;
+        Systems systems_;
+        Bodies tables_[3];
+        std::unique_ptr<OrbitEngine> engine_;
+
+        Id allocate(Kind kind, Id row);
+
+        Id addBody(Kind kind, Id parent, std::u32string name, Scalar radius, const OrbitalBodyResource *resource, const Orbit &orbit);
+
+        Bodies &table(Kind kind);
+
+        const Bodies &table(Kind kind) const;
+
+        void erase(Id id);
+
+        BodyStore(const BodyStore &) = delete;
+        BodyStore &operator=(const BodyStore &) = delete;
+    };
+
+}
+
+#endif	/* BODYSTORE_H */
+
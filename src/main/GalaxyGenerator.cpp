@@ -0,0 +1,230 @@
+#include "GalaxyGenerator.h"
+
+#include <algorithm>
+#include <random>
+#include <cmath>
+
+using namespace Game;
+
+namespace {
+
+    // expected systems per sector, sectors only grow beyond for the minimum distance
+    const Scalar SYSTEMS_PER_SECTOR = 16.;
+
+    const std::size_t MAX_CELLS_PER_SIDE = 8;
+
+    // candidates tried per system before a crowded sector gives up
+    const unsigned ATTEMPTS = 64;
+
+    // density samples per sector side for its mass and peak
+    const unsigned SAMPLES = 4;
+
+    const Scalar PI = 3.14159265358979323846;
+
+    std::uint64_t mix(std::uint64_t x){
+        // splitmix64 finalizer
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    /*
+     * Uniform in 0..1 from the top 53 bits, the same on every standard library
+     */
+    Scalar uniform(std::mt19937_64 &random){
+        return (random() >> 11) * (1. / 9007199254740992.);
+    }
+
+}
+
+GalaxyParameters::GalaxyParameters() : count(), seed(), center(), radius(), minDistance(), profile(DensityProfile::UNIFORM), scale(), arms(), twist(){
+}
+
+GalaxyGenerator::GalaxyGenerator(const GalaxyParameters &parameters) : parameters_(parameters), sectorSize_(), sectorsPerSide_(1), cellsPerSide_(1), sectors_(){
+    const Scalar width = 2. * parameters_.radius;
+    sectorSize_ = std::max(parameters_.minDistance, width / std::sqrt(std::max(parameters_.count / SYSTEMS_PER_SECTOR, 1.)));
+    if(sectorSize_ > 0.){
+        sectorsPerSide_ = std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(width / sectorSize_)));
+    }
+    if(parameters_.minDistance > 0.){
+        Scalar cells = std::floor(sectorSize_ / parameters_.minDistance * 2.);
+        cellsPerSide_ = std::min<std::size_t>(MAX_CELLS_PER_SIDE, std::max<std::size_t>(1, static_cast<std::size_t>(cells)));
+    }
+}
+
+Scalar GalaxyGenerator::density(Position position) const{
+    Scalar dx = position.x - parameters_.center.x;
+    Scalar dy = position.y - parameters_.center.y;
+    Scalar distance = std::hypot(dx, dy);
+    if(distance > parameters_.radius){
+        return 0.;
+    }
+    switch(parameters_.profile){
+        case DensityProfile::GAUSSIAN:
+            return std::exp(-distance * distance / (2. * parameters_.scale * parameters_.scale));
+        case DensityProfile::DISC:{
+            Scalar disc = std::exp(-distance / parameters_.scale);
+            if(parameters_.arms == 0){
+                return disc;
+            }
+            Scalar angle = std::atan2(dy, dx) - 2. * PI * parameters_.twist * distance / parameters_.radius;
+            // the space between the arms is thinned, not emptied
+            return disc * (0.25 + 0.375 * (1. + std::cos(parameters_.arms * angle)));
+        }
+        default:
+            return 1.;
+    }
+}
+
+Position GalaxyGenerator::origin(std::size_t sector) const{
+    return Position{
+        parameters_.center.x - parameters_.radius + (sector % sectorsPerSide_) * sectorSize_,
+        parameters_.center.y - parameters_.radius + (sector / sectorsPerSide_) * sectorSize_
+    };
+}
+
+void GalaxyGenerator::measure(std::size_t index){
+    Sector &sector = sectors_[index];
+    Position corner = origin(index);
+    Scalar sum = 0.;
+    for(unsigned y = 0; y < SAMPLES; ++y){
+        for(unsigned x = 0; x < SAMPLES; ++x){
+            Scalar value = density(Position{corner.x + (x + 0.5) * sectorSize_ / SAMPLES, corner.y + (y + 0.5) * sectorSize_ / SAMPLES});
+            sum += value;
+            sector.peak = std::max(sector.peak, value);
+        }
+    }
+    sector.mass = sum / (SAMPLES * SAMPLES) * sectorSize_ * sectorSize_;
+}
+
+bool GalaxyGenerator::vacant(std::size_t index, Position candidate) const{
+    const Scalar distance = parameters_.minDistance;
+    if(distance <= 0.){
+        return true;
+    }
+    const Scalar cellSize = sectorSize_ / cellsPerSide_;
+    const std::size_t sx = index % sectorsPerSide_;
+    const std::size_t sy = index / sectorsPerSide_;
+    for(std::size_t y = sy > 0 ? sy - 1 : 0; y <= std::min(sy + 1, sectorsPerSide_ - 1); ++y){
+        for(std::size_t x = sx > 0 ? sx - 1 : 0; x <= std::min(sx + 1, sectorsPerSide_ - 1); ++x){
+            const std::size_t neighbour = y * sectorsPerSide_ + x;
+            const Sector &sector = sectors_[neighbour];
+            if(sector.points.empty()){
+                continue;
+            }
+            Position corner = origin(neighbour);
+            Scalar left = (candidate.x - distance - corner.x) / cellSize;
+            Scalar right = (candidate.x + distance - corner.x) / cellSize;
+            Scalar top = (candidate.y - distance - corner.y) / cellSize;
+            Scalar bottom = (candidate.y + distance - corner.y) / cellSize;
+            const Scalar last = static_cast<Scalar>(cellsPerSide_ - 1);
+            if(right < 0. || bottom < 0. || left > last + 1. || top > last + 1.){
+                continue;
+            }
+            std::size_t cx0 = static_cast<std::size_t>(std::max(left, 0.));
+            std::size_t cx1 = static_cast<std::size_t>(std::min(right, last));
+            std::size_t cy0 = static_cast<std::size_t>(std::max(top, 0.));
+            std::size_t cy1 = static_cast<std::size_t>(std::min(bottom, last));
+            for(std::size_t cy = cy0; cy <= cy1; ++cy){
+                for(std::size_t cx = cx0; cx <= cx1; ++cx){
+                    for(std::int32_t i = sector.cells[cy * cellsPerSide_ + cx]; i >= 0; i = sector.next[i]){
+                        Scalar dx = sector.points[i].x - candidate.x;
+                        Scalar dy = sector.points[i].y - candidate.y;
+                        if(dx * dx + dy * dy < distance * distance){
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void GalaxyGenerator::add(Sector &sector, std::size_t index, Position point){
+    Position corner = origin(index);
+    const Scalar cellSize = sectorSize_ / cellsPerSide_;
+    std::size_t cx = std::min(static_cast<std::size_t>(std::max((point.x - corner.x) / cellSize, 0.)), cellsPerSide_ - 1);
+    std::size_t cy = std::min(static_cast<std::size_t>(std::max((point.y - corner.y) / cellSize, 0.)), cellsPerSide_ - 1);
+    std::int32_t &cell = sector.cells[cy * cellsPerSide_ + cx];
+    sector.next.push_back(cell);
+    cell = static_cast<std::int32_t>(sector.points.size());
+    sector.points.push_back(point);
+}
+
+void GalaxyGenerator::fill(std::size_t index, Scalar totalMass){
+    Sector &sector = sectors_[index];
+    if(sector.mass <= 0.){
+        return;
+    }
+    std::mt19937_64 random{mix(parameters_.seed ^ mix(index))};
+    Scalar expected = parameters_.count * sector.mass / totalMass;
+    std::size_t wanted = static_cast<std::size_t>(expected);
+    if(uniform(random) < expected - wanted){
+        ++wanted;
+    }
+    sector.cells.assign(cellsPerSide_ * cellsPerSide_, -1);
+    sector.points.reserve(wanted);
+    sector.next.reserve(wanted);
+    Position corner = origin(index);
+    // a system failing all attempts means the sector is full
+    bool full = false;
+    for(std::size_t n = 0; n < wanted && !full; ++n){
+        full = true;
+        for(unsigned attempt = 0; attempt < ATTEMPTS; ++attempt){
+            // rejection sampling follows the density within the sector
+            Position candidate;
+            Scalar value = 0.;
+            for(unsigned sample = 0; sample < ATTEMPTS && (value <= 0. || uniform(random) * sector.peak > value); ++sample){
+                candidate = Position{corner.x + uniform(random) * sectorSize_, corner.y + uniform(random) * sectorSize_};
+                value = density(candidate);
+            }
+            if(value > 0. && vacant(index, candidate)){
+                add(sector, index, candidate);
+                full = false;
+                break;
+            }
+        }
+    }
+}
+
+void GalaxyGenerator::generate(Core::ThreadPool &pool, std::vector<Position> &positions){
+    positions.clear();
+    if(parameters_.count == 0 || !(parameters_.radius > 0.)){
+        return;
+    }
+    const std::size_t count = sectorsPerSide_ * sectorsPerSide_;
+    sectors_.assign(count, Sector{});
+    pool.parallel(count, [this](std::size_t i){
+        measure(i);
+    });
+    Scalar totalMass = 0.;
+    for(const Sector &sector : sectors_){
+        totalMass += sector.mass;
+    }
+    if(totalMass > 0.){
+        // no two sectors of a pass are neighbours
+        std::vector<std::size_t> pass;
+        for(std::size_t parity = 0; parity < 4; ++parity){
+            pass.clear();
+            for(std::size_t y = parity / 2; y < sectorsPerSide_; y += 2){
+                for(std::size_t x = parity % 2; x < sectorsPerSide_; x += 2){
+                    pass.push_back(y * sectorsPerSide_ + x);
+                }
+            }
+            pool.parallel(pass.size(), [this, &pass, totalMass](std::size_t i){
+                fill(pass[i], totalMass);
+            });
+        }
+    }
+    std::size_t total = 0;
+    for(const Sector &sector : sectors_){
+        total += sector.points.size();
+    }
+    positions.reserve(total);
+    for(const Sector &sector : sectors_){
+        positions.insert(positions.end(), sector.points.begin(), sector.points.end());
+    }
+    std::vector<Sector>{}.swap(sectors_);
+}
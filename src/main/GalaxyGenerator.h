@@ -0,0 +1,104 @@
+/*
+ * File:   GalaxyGenerator.h
+ * Author: hans
+ *
+ * Created on October 20, 2026, 8:10 PM
+ */
+
+#ifndef GALAXYGENERATOR_H
+#define	GALAXYGENERATOR_H
+
+#include "Graphics.h"
+#include "ThreadPool.h"
+
+#include <vector>
+#include <cstdint>
+
+namespace Game{
+
+    /*
+     * How the systems are spread over the galaxy
+     */
+    enum class DensityProfile{
+        UNIFORM,
+        // falls off with the distance from the center, scale being the deviation
+        GAUSSIAN,
+        // falls off exponentially with scale, optionally with spiral arms
+        DISC
+    };
+
+    struct GalaxyParameters{
+        // systems to place, fewer fit if the minimum distance is too large
+        std::size_t count;
+        std::uint64_t seed;
+        Position center;
+        Scalar radius;
+        Scalar minDistance;
+        DensityProfile profile;
+        Scalar scale;
+        // spiral arms of a disc, 0 for none
+        unsigned arms;
+        // turns of the arms from the center to the edge
+        Scalar twist;
+
+        GalaxyParameters();
+    };
+
+    /*
+     * Places systems no closer than the minimum distance to each other by
+     * dart throwing in a grid of sectors. Sectors are at least the minimum
+     * distance wide, so only neighbours interact: they are generated in four
+     * passes of non-adjacent sectors, each sector in parallel with its own
+     * random stream seeded by the seed and its coordinates. The result
+     * only depends on the parameters, never on the number of threads.
+     */
+    class GalaxyGenerator{
+    public:
+
+        GalaxyGenerator(const GalaxyParameters &parameters);
+
+        /*
+         * Positions of the systems, sector by sector
+         */
+        void generate(Core::ThreadPool &pool, std::vector<Position> &positions);
+
+        /*
+         * Relative density at position, 0 outside the galaxy
+         */
+        Scalar density(Position position) const;
+
+    private:
+
+        struct Sector{
+            std::vector<Position> points;
+            // first point of every cell, linked on through next
+            std::vector<std::int32_t> cells;
+            std::vector<std::int32_t> next;
+            Scalar mass;
+            Scalar peak;
+        };
+
+        GalaxyParameters parameters_;
+        Scalar sectorSize_;
+        std::size_t sectorsPerSide_;
+        std::size_t cellsPerSide_;
+        std::vector<Sector> sectors_;
+
+        void measure(std::size_t sector);
+
+        void fill(std::size_t sector, Scalar totalMass);
+
+        bool vacant(std::size_t sector, Position candidate) const;
+
+        void add(Sector &sector, std::size_t index, Position point);
+
+        Position origin(std::size_t sector) const;
+
+        GalaxyGenerator(const GalaxyGenerator &) = delete;
+        GalaxyGenerator &operator=(const GalaxyGenerator &) = delete;
+    };
+
+}
+
+#endif	/* GALAXYGENERATOR_H */
+
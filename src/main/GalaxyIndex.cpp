@@ -0,0 +1,127 @@
+#include "GalaxyIndex.h"
+
+#include <algorithm>
+#include <utility>
+
+using namespace Game;
+
+namespace {
+
+    // covers the maps of cloud.py, the root grows for larger ones
+    const Scalar ROOT_SIZE = 4e9;
+
+    // about the size of a planet
+    const Scalar MIN_CELL_SIZE = 1e3;
+
+}
+
+GalaxyIndex::GalaxyIndex(const BodyStore &store) : store_(store), tree_(ROOT_SIZE, MIN_CELL_SIZE), systems_(){
+}
+
+Core::Bounds<Scalar> GalaxyIndex::bounds(Position center, Scalar radius){
+    return Core::Bounds<Scalar>{center.x - radius, center.x + radius, center.y - radius, center.y + radius};
+}
+
+Scalar GalaxyIndex::radius(const Entry &entry) const{
+    return entry.body == BodyStore::NONE ? 0. : store_.radius(entry.body);
+}
+
+void GalaxyIndex::insert(BodyStore::Id system, const std::vector<BodyStore::Id> &bodies){
+    Record record;
+    Scalar largest = 0.;
+    for(BodyStore::Id body : bodies){
+        Scalar radius = store_.radius(body);
+        record.bodies.push_back(tree_.insert(Entry{system, body}, bounds(store_.position(body), radius)));
+        largest = std::max(largest, radius);
+    }
+    Scalar extent = store_.engine().extent(store_.orbit(system));
+    record.system = tree_.insert(Entry{system, BodyStore::NONE}, bounds(store_.position(system), extent + largest));
+    systems_.insert(std::make_pair(system, std::move(record)));
+}
+
+void GalaxyIndex::add(BodyStore::Id system){
+    if(!store_.contains(system) || store_.kind(system) != BodyStore::Kind::SYSTEM){
+        return;
+    }
+    remove(system);
+    std::vector<BodyStore::Id> bodies;
+    for(BodyStore::Id body = store_.firstChild(system); body != BodyStore::NONE; body = store_.next(body, system)){
+        if(store_.kind(body) != BodyStore::Kind::BARYCENTER){
+            bodies.push_back(body);
+        }
+    }
+    insert(system, bodies);
+}
+
+void GalaxyIndex::build(){
+    clear();
+    for(BodyStore::Id system : store_.systems().ids){
+        add(system);
+    }
+}
+
+void GalaxyIndex::remove(BodyStore::Id system){
+    auto found = systems_.find(system);
+    if(found == systems_.end()){
+        return;
+    }
+    tree_.remove(found->second.system);
+    for(Tree::Handle handle : found->second.bodies){
+        tree_.remove(handle);
+    }
+    systems_.erase(found);
+}
+
+void GalaxyIndex::clear(){
+    tree_.clear();
+    systems_.clear();
+}
+
+void GalaxyIndex::update(const OrbitFrame &frame, const Core::Bounds<Scalar> &bounds){
+    std::vector<BodyStore::Id> systems;
+    tree_.query(bounds, [this, &systems](Tree::Handle handle){
+        const Entry &entry = tree_[handle];
+        if(entry.body == BodyStore::NONE){
+            systems.push_back(entry.system);
+        }
+    });
+    const OrbitEngine *engine = &store_.engine();
+    for(BodyStore::Id system : systems){
+        for(Tree::Handle handle : systems_[system].bodies){
+            const Entry &entry = tree_[handle];
+            tree_.update(handle, this->bounds(frame.position(engine, store_.orbit(entry.body)), radius(entry)));
+        }
+    }
+}
+
+void GalaxyIndex::query(const Core::Bounds<Scalar> &bounds, std::vector<Entry> &entries) const{
+    entries.clear();
+    tree_.query(bounds, [this, &entries](Tree::Handle handle){
+        entries.push_back(tree_[handle]);
+    });
+}
+
+void GalaxyIndex::pick(Position point, std::vector<Entry> &entries) const{
+    std::vector<std::pair<Scalar, Entry> > found;
+    tree_.query(point, [this, point, &found](Tree::Handle handle){
+        const Entry &entry = tree_[handle];
+        const Core::Bounds<Scalar> &bounds = tree_.bounds(handle);
+        Scalar dx = (bounds.left + bounds.right) / 2 - point.x;
+        Scalar dy = (bounds.top + bounds.bottom) / 2 - point.y;
+        Scalar radius = this->radius(entry);
+        if(entry.body != BodyStore::NONE && dx * dx + dy * dy <= radius * radius){
+            found.push_back(std::make_pair(dx * dx + dy * dy, entry));
+        }
+    });
+    std::stable_sort(found.begin(), found.end(), [](const std::pair<Scalar, Entry> &a, const std::pair<Scalar, Entry> &b){
+        return a.first < b.first;
+    });
+    entries.clear();
+    for(auto &pair : found){
+        entries.push_back(pair.second);
+    }
+}
+
+std::size_t GalaxyIndex::size() const{
+    return systems_.size();
+}
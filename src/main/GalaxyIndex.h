@@ -0,0 +1,93 @@
+/*
+ * File:   GalaxyIndex.h
+ * Author: hans
+ *
+ * Created on October 20, 2026, 3:00 PM
+ */
+
+#ifndef GALAXYINDEX_H
+#define	GALAXYINDEX_H
+
+#include "Star.h"
+#include "LooseQuadtree.h"
+
+#include <vector>
+#include <unordered_map>
+
+namespace Game{
+
+    /*
+     * Where star systems and their bodies are, for culling and picking.
+     * Systems are indexed by the area their orbits never leave, bodies by
+     * their position at the last update() covering them, so only the bodies
+     * of the systems in view need to be moved each frame.
+     *
+     * Systems are added and removed while their orbits are not simulated,
+     * bodies added to an indexed system are only found after adding it again.
+     */
+    class GalaxyIndex{
+    public:
+
+        struct Entry{
+            BodyStore::Id system;
+            // the indexed star or planet, NONE for the system itself
+            BodyStore::Id body;
+        };
+
+        GalaxyIndex(const BodyStore &store);
+
+        void add(BodyStore::Id system);
+
+        /*
+         * Indexes every system of the store in one pass over its tables
+         */
+        void build();
+
+        void remove(BodyStore::Id system);
+
+        void clear();
+
+        /*
+         * Moves the bodies of the systems intersecting bounds to their
+         * positions in frame
+         */
+        void update(const OrbitFrame &frame, const Core::Bounds<Scalar> &bounds);
+
+        /*
+         * Systems and bodies intersecting bounds
+         */
+        void query(const Core::Bounds<Scalar> &bounds, std::vector<Entry> &entries) const;
+
+        /*
+         * Bodies covering point, the closest center first
+         */
+        void pick(Position point, std::vector<Entry> &entries) const;
+
+        std::size_t size() const;
+
+    private:
+        using Tree = Core::LooseQuadtree<Entry, Scalar>;
+
+        struct Record{
+            Tree::Handle system;
+            std::vector<Tree::Handle> bodies;
+        };
+
+        const BodyStore &store_;
+        Tree tree_;
+        std::unordered_map<BodyStore::Id, Record> systems_;
+
+        static Core::Bounds<Scalar> bounds(Position center, Scalar radius);
+
+        Scalar radius(const Entry &entry) const;
+
+        void insert(BodyStore::Id system, const std::vector<BodyStore::Id> &bodies);
+
+        GalaxyIndex(const GalaxyIndex &) = delete;
+        GalaxyIndex &operator=(const GalaxyIndex &) = delete;
+    };
+
+}
+
+#endif	/* GALAXYINDEX_H */
+
@@ -8,6 +8,12 @@ using namespace Game;
 ViewPoint::ViewPoint(Position position_, Scalar zoom_, ViewMode mode_) : position(position_), zoom(zoom_), mode(mode_){
 }
 
+Core::Bounds<Scalar> ViewPoint::bounds() const{
+    Scalar half = 1. / zoom;
+    Position center{-position.x * half, -position.y * half};
+    return Core::Bounds<Scalar>{center.x - half, center.x + half, center.y - half, center.y + half};
+}
+
 void ViewPoint::loadProjectionMatrix() const{
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
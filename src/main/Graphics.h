@@ -40,6 +40,11 @@ namespace Game {
         ViewPoint(Position position_, Scalar zoom_, ViewMode mode_);
 
         void loadProjectionMatrix() const;
+        
+        /*
+         * Part of the world shown with this view point
+         */
+        Core::Bounds<Scalar> bounds() const;
     };
 
 }
@@ -7,4 +7,10 @@ using namespace Game;
 
 IO::Document Game::IO::open(std::istream &input){
     return Document{JSON::BufferedInput<>{input}};
+};
+
+void Game::IO::loadProperties(Core::Path path, FrozenProperties &properties){
+    Properties buffer;
+    loadProperties(path, buffer);
+    properties.build(buffer);
 };
\ No newline at end of file
@@ -10,6 +10,7 @@
 
 #include "JSONReader.h"
 #include "Properties.h"
+#include "FrozenProperties.h"
 #include "Path.h"
 
 namespace Game {
@@ -26,6 +27,8 @@ namespace Game {
         using Properties = std::map<std::string, PlainPropertyValue>;
         using UnicodeProperties = std::map<std::u32string, UnicodePropertyValue>;
 
+        using FrozenProperties = Core::FrozenPropertyMap;
+
         template<typename Char> class Buffer {
         private:
             Char *data_;
@@ -84,7 +87,8 @@ namespace Game {
         Document open(std::istream &input);
 
         template<typename Char, typename CharTraits> void loadUTF8Properties(std::istream& input, std::map<std::basic_string<Char, CharTraits>, Core::PropertyValue<Char, CharTraits> > & properties) {
-            static Core::PropertyLoader<Char, CharTraits> loader;
+            // per call, the parser keeps scratch buffers that concurrent loads would share
+            Core::PropertyLoader<Char, CharTraits> loader;
             loader.loadUTF8(input, properties);
         };
 
@@ -95,9 +99,9 @@ namespace Game {
         };
 
         template<typename Char, typename CharTraits> void loadProperties(std::istream& input, std::map<std::basic_string<Char, CharTraits>, Core::PropertyValue<Char, CharTraits> > & properties) {
-            static Core::PropertyLoader<Char, CharTraits> loader;
+            Core::PropertyLoader<Char, CharTraits> loader;
             IO::Buffer<char> buffer{input};
-            loader.load(buffer.begin(), buffer.end(), properties);
+            loader.loadParallel(buffer.begin(), buffer.end(), properties);
         };
 
         template<typename Char, typename CharTraits> void loadProperties(Core::Path path, std::map<std::basic_string<Char, CharTraits>, Core::PropertyValue<Char, CharTraits> > & properties) {
@@ -105,6 +109,8 @@ namespace Game {
             path.openFile(input);
             loadProperties(input, properties);
         };
+
+        void loadProperties(Core::Path path, FrozenProperties &properties);
     }
 
 }
@@ -5,6 +5,8 @@
 #include <python3.4/Python.h>
 #include <boost/python.hpp>
 #include <fstream>
+#include <unordered_map>
+#include <cstring>
 
 using namespace Game;
 
@@ -13,44 +15,132 @@ const std::string MapGenerator::NAME{"mapgenerator"};
 MapGeneratorException::MapGeneratorException(std::string message) : std::runtime_error(message) {
 }
 
-MapGenerator::MapGenerator() : systems_(), currentStarSystem_(), currentOrbitalSystem_(), currentOrbit_(), name(), radius(), position(), resourceId(), session_() {
+MapGenerator::MapGenerator() : store_(), currentStarSystem_(BodyStore::NONE), currentParent_(BodyStore::NONE), currentOrbit_(), name(), radius(), position(), resourceId(), session_(), starHandle_(), planetHandle_() {
 }
 
 MapGenerator::~MapGenerator() {
-    delete currentStarSystem_;
     delete currentOrbit_;
-    for (StarSystem *system : systems_) {
-        delete system;
-    }
 }
 
 void MapGenerator::beginMap(Session *session) {
-    delete currentStarSystem_;
-    currentStarSystem_ = nullptr;
-    currentOrbitalSystem_ = nullptr;
+    currentStarSystem_ = BodyStore::NONE;
+    currentParent_ = BodyStore::NONE;
     delete currentOrbit_;
     currentOrbit_ = nullptr;
-    for (StarSystem *system : systems_) {
-        delete system;
-    }
-    systems_.clear();
+    store_.clear();
     session_ = session;
+    starHandle_ = Core::ResourceHandle{};
+    planetHandle_ = Core::ResourceHandle{};
 }
 
-StarSystem& MapGenerator::currentSystem() {
-    if (currentStarSystem_) {
-        return *currentStarSystem_;
+StarSystem MapGenerator::currentSystem() {
+    if (currentStarSystem_ != BodyStore::NONE) {
+        return StarSystem{store_, currentStarSystem_};
     } else {
         throw MapGeneratorException{"no current star system"};
     }
 }
 
+BodyStore &MapGenerator::store() {
+    return store_;
+}
+
 void MapGenerator::nextStarSystem() {
-    if (currentStarSystem_) {
-        systems_.push_back(currentStarSystem_);
+    currentStarSystem_ = store_.addSystem(name, position);
+    currentParent_ = currentStarSystem_;
+}
+
+std::size_t MapGenerator::generateSystems(GalaxyParameters parameters) {
+    if (!(parameters.radius > 0.) || !(parameters.minDistance >= 0.)) {
+        throw MapGeneratorException{"galaxy radius or system distance out of range"};
+    }
+    if (parameters.profile != DensityProfile::UNIFORM && !(parameters.scale > 0.)) {
+        throw MapGeneratorException{"density profile scale out of range"};
+    }
+    parameters.center = position;
+    GalaxyGenerator generator{parameters};
+    std::vector<Position> positions;
+    if (session_) {
+        generator.generate(session_->workers(), positions);
+    } else {
+        Core::ThreadPool pool{};
+        generator.generate(pool, positions);
+    }
+    for (Position position : positions) {
+        currentStarSystem_ = store_.addSystem(name, position);
+    }
+    currentParent_ = currentStarSystem_;
+    return positions.size();
+}
+
+std::vector<BodyStore::Id> MapGenerator::addSystems(const std::vector<Position> &positions) {
+    std::vector<BodyStore::Id> ids;
+    ids.reserve(positions.size());
+    store_.reserve(BodyStore::Kind::SYSTEM, positions.size());
+    for (Position position : positions) {
+        ids.push_back(store_.addSystem(name, position));
+    }
+    if (!ids.empty()) {
+        currentStarSystem_ = ids.back();
+        currentParent_ = currentStarSystem_;
+    }
+    return ids;
+}
+
+std::vector<BodyStore::Id> MapGenerator::addStars(const BodyBatch &stars) {
+    return addBodies(BodyStore::Kind::STAR, stars);
+}
+
+std::vector<BodyStore::Id> MapGenerator::addPlanets(const BodyBatch &planets) {
+    return addBodies(BodyStore::Kind::PLANET, planets);
+}
+
+std::vector<BodyStore::Id> MapGenerator::addBodies(BodyStore::Kind kind, const BodyBatch &bodies) {
+    const std::size_t count = bodies.parents.size();
+    if (bodies.radii.size() != count || bodies.semiMajorAxes.size() != count || bodies.eccentricities.size() != count
+            || bodies.periapsisArguments.size() != count || bodies.meanMotions.size() != count || bodies.meanAnomalies.size() != count
+            || (bodies.resourceIds.size() != count && bodies.resourceIds.size() != 1)) {
+        throw MapGeneratorException{"body arrays differ in length"};
+    }
+    if (count == 0) {
+        return std::vector<BodyStore::Id>{};
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!store_.contains(bodies.parents[i])) {
+            throw MapGeneratorException{"unknown parent of body " + std::to_string(i)};
+        }
+        if (!(bodies.eccentricities[i] >= 0. && bodies.eccentricities[i] < 1.)) {
+            throw MapGeneratorException{"eccentricity of body " + std::to_string(i) + " outside of [0, 1)"};
+        }
     }
-    currentStarSystem_ = new StarSystem(name, position);
-    currentOrbitalSystem_ = currentStarSystem_;
+    // every distinct resource is resolved once
+    std::unordered_map<std::string, const OrbitalBodyResource *> resources;
+    for (const std::string &id : bodies.resourceIds) {
+        if (resources.count(id)) {
+            continue;
+        }
+        if (id.empty()) {
+            resources[id] = kind == BodyStore::Kind::STAR ? starResource() : planetResource();
+        } else if (session_) {
+            const OrbitalBodyResourceLoader &loader = kind == BodyStore::Kind::STAR ? session_->starResourceLoader() : session_->planetResourceLoader();
+            resources[id] = loader[loader.resolve(id)];
+        } else {
+            throw MapGeneratorException{"no current session"};
+        }
+    }
+    std::vector<BodyStore::Id> ids;
+    ids.reserve(count);
+    store_.reserve(kind, count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const OrbitalBodyResource *resource = resources[bodies.resourceIds[bodies.resourceIds.size() == 1 ? 0 : i]];
+        EllipticalOrbit orbit{bodies.semiMajorAxes[i], bodies.eccentricities[i], bodies.periapsisArguments[i], bodies.meanMotions[i], bodies.meanAnomalies[i]};
+        if (kind == BodyStore::Kind::STAR) {
+            ids.push_back(store_.addStar(bodies.parents[i], name, bodies.radii[i], resource, orbit));
+        } else {
+            ids.push_back(store_.addPlanet(bodies.parents[i], name, bodies.radii[i], resource, orbit));
+        }
+    }
+    return ids;
 }
 
 void MapGenerator::circularOrbit(Scalar radius, Scalar angularSpeed, Scalar startAngle) {
@@ -67,42 +157,60 @@ void MapGenerator::staticOrbit(Position relativePosition) {
     currentOrbit_ = new StaticOrbit{relativePosition};
 }
 
-void MapGenerator::push(OrbitalSystem* orbits) {
+void MapGenerator::ellipticalOrbit(Scalar semiMajorAxis, Scalar eccentricity, Scalar periapsisArgument, Scalar meanMotion, Scalar meanAnomaly) {
+    if (!(eccentricity >= 0. && eccentricity < 1.)) {
+        throw MapGeneratorException{"eccentricity outside of [0, 1)"};
+    }
     if (currentOrbit_) {
-        attach(currentOrbitalSystem_, orbits, currentOrbit_);
-        currentOrbitalSystem_ = orbits;
-        currentOrbit_ = nullptr;
-    } else {
-        delete orbits;
+        delete currentOrbit_;
+    }
+    currentOrbit_ = new EllipticalOrbit{semiMajorAxis, eccentricity, periapsisArgument, meanMotion, meanAnomaly};
+}
+
+void MapGenerator::push(BodyStore::Kind kind, const OrbitalBodyResource *resource) {
+    if (currentStarSystem_ == BodyStore::NONE) {
+        throw MapGeneratorException{"no star system specified"};
+    }
+    if (!currentOrbit_) {
         throw MapGeneratorException{"no orbit specified"};
     }
+    BodyStore::Id body;
+    switch (kind) {
+        case BodyStore::Kind::STAR:
+            body = store_.addStar(currentParent_, name, radius, resource, *currentOrbit_);
+            break;
+        case BodyStore::Kind::PLANET:
+            body = store_.addPlanet(currentParent_, name, radius, resource, *currentOrbit_);
+            break;
+        default:
+            body = store_.addBarycenter(currentParent_, *currentOrbit_);
+            break;
+    }
+    delete currentOrbit_;
+    currentOrbit_ = nullptr;
+    if (body == BodyStore::NONE) {
+        throw MapGeneratorException{"orbit rejected"};
+    }
+    currentParent_ = body;
 }
 
 void MapGenerator::pushOrbits() {
-    push(new OrbitalSystem{});
+    push(BodyStore::Kind::BARYCENTER, nullptr);
 }
 
 void MapGenerator::pushStar() {
-    if (currentStarSystem_) {
-        push(new Star{currentStarSystem_, name, radius, starResource()});
-    } else {
-        throw MapGeneratorException{"no star system specified"};
-    }
+    push(BodyStore::Kind::STAR, starResource());
 }
 
 void MapGenerator::pushPlanet() {
-    if (currentStarSystem_) {
-        push(new Planet{currentStarSystem_, name, radius, planetResource()});
-    } else {
-        throw MapGeneratorException{"no star system specified"};
-    }
+    push(BodyStore::Kind::PLANET, planetResource());
 }
 
 void MapGenerator::popOrbits() {
-    if (currentOrbitalSystem_) {
-        OrbitalSystem *parent = currentOrbitalSystem_->orbit()->system();
-        if (parent) {
-            currentOrbitalSystem_ = parent;
+    if (currentParent_ != BodyStore::NONE) {
+        BodyStore::Id parent = store_.parent(currentParent_);
+        if (parent != BodyStore::NONE) {
+            currentParent_ = parent;
         } else {
             throw MapGeneratorException{"no parent orbital system specified"};
         }
@@ -113,7 +221,11 @@ void MapGenerator::popOrbits() {
 
 const OrbitalBodyResource* MapGenerator::planetResource() {
     if (session_) {
-        return session_->planetResourceLoader()["gas_giant_01"];
+        const PlanetResourceLoader &loader = session_->planetResourceLoader();
+        if (!planetHandle_.valid()) {
+            planetHandle_ = loader.resolve("gas_giant_01");
+        }
+        return loader[planetHandle_];
     } else {
         throw MapGeneratorException{"no current session"};
     }
@@ -121,7 +233,11 @@ const OrbitalBodyResource* MapGenerator::planetResource() {
 
 const OrbitalBodyResource* MapGenerator::starResource() {
     if (session_) {
-        return session_->starResourceLoader()["main_sequence_yellow_01"];
+        const StarResourceLoader &loader = session_->starResourceLoader();
+        if (!starHandle_.valid()) {
+            starHandle_ = loader.resolve("main_sequence_yellow_01");
+        }
+        return loader[starHandle_];
     } else {
         throw MapGeneratorException{"no current session"};
     }
@@ -139,6 +255,114 @@ void MapGenerator::run(std::string scriptCode) {
     }
 }
 
+namespace {
+
+    template<typename T, typename Item> bool copyItems(const Py_buffer &view, std::vector<T> &values) {
+        if (view.itemsize != sizeof(Item)) {
+            return false;
+        }
+        const char *item = static_cast<const char *>(view.buf);
+        values.reserve(view.shape[0]);
+        for (Py_ssize_t i = 0; i < view.shape[0]; ++i, item += view.strides[0]) {
+            Item value;
+            std::memcpy(&value, item, sizeof(Item));
+            values.push_back(static_cast<T>(value));
+        }
+        return true;
+    }
+
+    /*
+     * Copies a one dimensional buffer of native numbers, false for any
+     * other layout
+     */
+    template<typename T> bool copyBuffer(const Py_buffer &view, std::vector<T> &values) {
+        const char *format = view.format ? view.format : "B";
+        if (*format == '@' || *format == '=' || *format == '<') {
+            ++format;
+        }
+        if (view.ndim != 1 || format[0] == '\0' || format[1] != '\0') {
+            return false;
+        }
+        switch (*format) {
+            case 'd': return copyItems<T, double>(view, values);
+            case 'f': return copyItems<T, float>(view, values);
+            case 'b': return copyItems<T, signed char>(view, values);
+            case 'B': return copyItems<T, unsigned char>(view, values);
+            case 'h': return copyItems<T, short>(view, values);
+            case 'H': return copyItems<T, unsigned short>(view, values);
+            case 'i': return copyItems<T, int>(view, values);
+            case 'I': return copyItems<T, unsigned int>(view, values);
+            case 'l': return copyItems<T, long>(view, values);
+            case 'L': return copyItems<T, unsigned long>(view, values);
+            case 'q': return copyItems<T, long long>(view, values);
+            case 'Q': return copyItems<T, unsigned long long>(view, values);
+            default: return false;
+        }
+    }
+
+    /*
+     * Numbers of an array supporting the buffer protocol in one copy, of
+     * any other sequence element by element
+     */
+    template<typename T> std::vector<T> toVector(const boost::python::object &sequence) {
+        std::vector<T> values;
+        PyObject *object = sequence.ptr();
+        if (PyObject_CheckBuffer(object)) {
+            Py_buffer view;
+            if (PyObject_GetBuffer(object, &view, PyBUF_STRIDES | PyBUF_FORMAT) == 0) {
+                bool copied = copyBuffer(view, values);
+                PyBuffer_Release(&view);
+                if (copied) {
+                    return values;
+                }
+                values.clear();
+            } else {
+                PyErr_Clear();
+            }
+        }
+        values.reserve(boost::python::len(sequence));
+        for (boost::python::stl_input_iterator<T> value{sequence}, end; value != end; ++value) {
+            values.push_back(*value);
+        }
+        return values;
+    }
+
+    /*
+     * A single string or a sequence of them
+     */
+    std::vector<std::string> toStrings(const boost::python::object &strings) {
+        boost::python::extract<std::string> single{strings};
+        if (single.check()) {
+            return std::vector<std::string>{single()};
+        }
+        return std::vector<std::string>(boost::python::stl_input_iterator<std::string>{strings}, boost::python::stl_input_iterator<std::string>{});
+    }
+
+    boost::python::list toList(const std::vector<BodyStore::Id> &ids) {
+        boost::python::list list;
+        for (BodyStore::Id id : ids) {
+            list.append(id);
+        }
+        return list;
+    }
+
+    MapGenerator::BodyBatch toBatch(const boost::python::object &parents, const boost::python::object &radii, const boost::python::object &resourceIds,
+            const boost::python::object &semiMajorAxes, const boost::python::object &eccentricities, const boost::python::object &periapsisArguments,
+            const boost::python::object &meanMotions, const boost::python::object &meanAnomalies) {
+        MapGenerator::BodyBatch batch;
+        batch.parents = toVector<BodyStore::Id>(parents);
+        batch.radii = toVector<Scalar>(radii);
+        batch.resourceIds = toStrings(resourceIds);
+        batch.semiMajorAxes = toVector<Scalar>(semiMajorAxes);
+        batch.eccentricities = toVector<Scalar>(eccentricities);
+        batch.periapsisArguments = toVector<Scalar>(periapsisArguments);
+        batch.meanMotions = toVector<Scalar>(meanMotions);
+        batch.meanAnomalies = toVector<Scalar>(meanAnomalies);
+        return batch;
+    }
+
+}
+
 class MapGeneratorWrapper{
 private:
     MapGenerator *mapGenerator_;
@@ -182,6 +406,86 @@ public:
         mapGenerator_->resourceId = resourceId;
     };
     
+    void circularOrbit(Scalar radius, Scalar angularSpeed, Scalar startAngle){
+        mapGenerator_->circularOrbit(radius, angularSpeed, startAngle);
+    };
+    
+    void staticOrbit(Scalar x, Scalar y){
+        mapGenerator_->staticOrbit(Position{x, y});
+    };
+    
+    void ellipticalOrbit(Scalar semiMajorAxis, Scalar eccentricity, Scalar periapsisArgument, Scalar meanMotion, Scalar meanAnomaly){
+        mapGenerator_->ellipticalOrbit(semiMajorAxis, eccentricity, periapsisArgument, meanMotion, meanAnomaly);
+    };
+    
+    void nextStarSystem(){
+        mapGenerator_->nextStarSystem();
+    };
+    
+    std::size_t generateSystems(std::size_t count, std::uint64_t seed, Scalar radius, Scalar minDistance, std::string profile, Scalar scale, unsigned arms, Scalar twist){
+        GalaxyParameters parameters;
+        parameters.count = count;
+        parameters.seed = seed;
+        parameters.radius = radius;
+        parameters.minDistance = minDistance;
+        if(profile == "uniform"){
+            parameters.profile = DensityProfile::UNIFORM;
+        }else if(profile == "gaussian"){
+            parameters.profile = DensityProfile::GAUSSIAN;
+        }else if(profile == "disc"){
+            parameters.profile = DensityProfile::DISC;
+        }else{
+            throw MapGeneratorException{"unknown density profile " + profile};
+        }
+        parameters.scale = scale;
+        parameters.arms = arms;
+        parameters.twist = twist;
+        return mapGenerator_->generateSystems(parameters);
+    };
+    
+    /*
+     * Bulk calls take sequences or buffers like array.array or numpy arrays
+     * and return the ids of the new entities
+     */
+    boost::python::list addSystems(boost::python::object xs, boost::python::object ys){
+        std::vector<Scalar> x = toVector<Scalar>(xs);
+        std::vector<Scalar> y = toVector<Scalar>(ys);
+        if(x.size() != y.size()){
+            throw MapGeneratorException{"coordinate arrays differ in length"};
+        }
+        std::vector<Position> positions(x.size());
+        for(std::size_t i = 0; i < positions.size(); ++i){
+            positions[i] = Position{x[i], y[i]};
+        }
+        return toList(mapGenerator_->addSystems(positions));
+    };
+    
+    boost::python::list addStars(boost::python::object parents, boost::python::object radii, boost::python::object resourceIds, boost::python::object semiMajorAxes,
+            boost::python::object eccentricities, boost::python::object periapsisArguments, boost::python::object meanMotions, boost::python::object meanAnomalies){
+        return toList(mapGenerator_->addStars(toBatch(parents, radii, resourceIds, semiMajorAxes, eccentricities, periapsisArguments, meanMotions, meanAnomalies)));
+    };
+    
+    boost::python::list addPlanets(boost::python::object parents, boost::python::object radii, boost::python::object resourceIds, boost::python::object semiMajorAxes,
+            boost::python::object eccentricities, boost::python::object periapsisArguments, boost::python::object meanMotions, boost::python::object meanAnomalies){
+        return toList(mapGenerator_->addPlanets(toBatch(parents, radii, resourceIds, semiMajorAxes, eccentricities, periapsisArguments, meanMotions, meanAnomalies)));
+    };
+    
+    void pushOrbits(){
+        mapGenerator_->pushOrbits();
+    };
+    
+    void pushStar(){
+        mapGenerator_->pushStar();
+    };
+    
+    void pushPlanet(){
+        mapGenerator_->pushPlanet();
+    };
+    
+    void popOrbits(){
+        mapGenerator_->popOrbits();
+    };
+    
     void setMapGenerator(MapGenerator *mapGenerator){
         mapGenerator_ = mapGenerator;
     };
@@ -203,6 +507,18 @@ public:
         wrapper.def("setPosition", &MapGeneratorWrapper::setPosition);
         wrapper.def("getResourceId", &MapGeneratorWrapper::getResourceId);
         wrapper.def("setResourceId", &MapGeneratorWrapper::setResourceId);
+        wrapper.def("circularOrbit", &MapGeneratorWrapper::circularOrbit);
+        wrapper.def("staticOrbit", &MapGeneratorWrapper::staticOrbit);
+        wrapper.def("ellipticalOrbit", &MapGeneratorWrapper::ellipticalOrbit);
+        wrapper.def("nextStarSystem", &MapGeneratorWrapper::nextStarSystem);
+        wrapper.def("generateSystems", &MapGeneratorWrapper::generateSystems);
+        wrapper.def("addSystems", &MapGeneratorWrapper::addSystems);
+        wrapper.def("addStars", &MapGeneratorWrapper::addStars);
+        wrapper.def("addPlanets", &MapGeneratorWrapper::addPlanets);
+        wrapper.def("pushOrbits", &MapGeneratorWrapper::pushOrbits);
+        wrapper.def("pushStar", &MapGeneratorWrapper::pushStar);
+        wrapper.def("pushPlanet", &MapGeneratorWrapper::pushPlanet);
+        wrapper.def("popOrbits", &MapGeneratorWrapper::popOrbits);
     };
     
 };
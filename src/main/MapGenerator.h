@@ -9,12 +9,14 @@
 #define	MAPGENERATOR_H
 
 #include "Star.h"
+#include "GalaxyGenerator.h"
 #include "Script.h"
 #include "Path.h"
 #include "Session.h"
 
 #include <string>
 #include <stdexcept>
+#include <vector>
 
 namespace Game{
     
@@ -28,6 +30,22 @@ namespace Game{
         
         static const std::string NAME;
         
+        /*
+         * Many bodies on elliptical orbits, one entry per body in every
+         * array. A single resource id applies to all, an empty one is the
+         * default resource.
+         */
+        struct BodyBatch{
+            std::vector<BodyStore::Id> parents;
+            std::vector<Scalar> radii;
+            std::vector<std::string> resourceIds;
+            std::vector<Scalar> semiMajorAxes;
+            std::vector<Scalar> eccentricities;
+            std::vector<Scalar> periapsisArguments;
+            std::vector<Scalar> meanMotions;
+            std::vector<Scalar> meanAnomalies;
+        };
+        
         MapGenerator();
         
         ~MapGenerator();
@@ -36,12 +54,39 @@ namespace Game{
         
         void staticOrbit(Position relativePosition);
         
-        StarSystem &currentSystem();
+        void ellipticalOrbit(Scalar semiMajorAxis, Scalar eccentricity, Scalar periapsisArgument, Scalar meanMotion, Scalar meanAnomaly);
+        
+        StarSystem currentSystem();
+        
+        /*
+         * Everything generated since beginMap
+         */
+        BodyStore &store();
         
         void beginMap(Session *session);
         
         void nextStarSystem();
         
+        /*
+         * Adds the systems of a generated galaxy around position, named
+         * name, and returns how many were placed. The same parameters give
+         * the same systems on any machine and number of threads.
+         */
+        std::size_t generateSystems(GalaxyParameters parameters);
+        
+        /*
+         * Adds a system named name at each position
+         */
+        std::vector<BodyStore::Id> addSystems(const std::vector<Position> &positions);
+        
+        /*
+         * Adds a whole batch or, if any entry is invalid, nothing. Parents
+         * must exist before the call.
+         */
+        std::vector<BodyStore::Id> addStars(const BodyBatch &stars);
+        
+        std::vector<BodyStore::Id> addPlanets(const BodyBatch &planets);
+        
         void pushOrbits();
         
         void pushStar();
@@ -56,16 +101,20 @@ namespace Game{
         
     private:
         
-        std::list<StarSystem *> systems_;
+        BodyStore store_;
         
-        StarSystem *currentStarSystem_;
+        BodyStore::Id currentStarSystem_;
         
-        OrbitalSystem *currentOrbitalSystem_;
+        BodyStore::Id currentParent_;
         
         Orbit *currentOrbit_;
         
         Session *session_;
         
+        Core::ResourceHandle starHandle_;
+        
+        Core::ResourceHandle planetHandle_;
+        
     public:
                 
         std::u32string name;
@@ -82,7 +131,9 @@ namespace Game{
         
         const OrbitalBodyResource *planetResource();
         
-        void push(OrbitalSystem *orbits);
+        void push(BodyStore::Kind kind, const OrbitalBodyResource *resource);
+        
+        std::vector<BodyStore::Id> addBodies(BodyStore::Kind kind, const BodyBatch &bodies);
         
         MapGenerator(const MapGenerator &) = delete;
         
@@ -5,10 +5,14 @@
 #include "Application.h"
 #include "String.h"
 #include "IO.h"
+#include "Data.h"
+#include "Hash.h"
+#include "VirtualFileSystem.h"
 
 #include <list>
 #include <set>
 #include <algorithm>
+#include <cstdio>
 
 using namespace Game;
 
@@ -33,7 +37,7 @@ bool Game::operator<(const LanguageDescriptor& first, const LanguageDescriptor &
 void ModuleLoader::readModuleDescriptor(Path modulePath, ModuleDescriptor &descriptor) const{
     descriptor.path = modulePath;
     descriptor.moduleId=modulePath.name();
-    std::ifstream input;
+    Core::FileInput input;
     Path descriptorPath{modulePath.child("module")};
     descriptorPath.openFile(input);
     if(descriptorPath.fileExists() && input.good()){
@@ -63,7 +67,7 @@ void ModuleLoader::readModuleDescriptor(Path modulePath, ModuleDescriptor &descr
 };
 
 void ModuleLoader::readLanguageDescriptors(Core::Path languagePath, std::set<LanguageDescriptor>& descriptors) const{
-    std::ifstream input;
+    Core::FileInput input;
     languagePath.openFile(input);
     if(languagePath.fileExists() && input.good()){
         try{
@@ -121,12 +125,12 @@ void ModuleLoader::createLanguages(std::set<LanguageDescriptor> descriptors, con
             std::string parentId = i->parentId;
             if(parentId.empty()){
                 done.push_back(*i);
-                languageMap.insert(std::make_pair(i->id, new Language{nullptr, i->id, *labels[i->id], createLocale(i->localeName)}));
+                languageMap.insert(std::make_pair(i->id, new Language{nullptr, i->id, labels[i->id], createLocale(i->localeName)}));
             }else{
                 auto parent = languageMap.find(parentId);
                 if(parent != languageMap.end()){
                     done.push_back(*i);
-                    languageMap.insert(std::make_pair(i->id, new Language{parent->second, i->id, *labels[i->id], createLocale(i->localeName)}));
+                    languageMap.insert(std::make_pair(i->id, new Language{parent->second, i->id, labels[i->id], createLocale(i->localeName)}));
                 }
             }
         }
@@ -147,7 +151,7 @@ void ModuleLoader::createLanguages(std::set<LanguageDescriptor> descriptors, con
     }
 }
 
-ModuleLoader::ModuleLoader() : modules_(), activeModule_(){};
+ModuleLoader::ModuleLoader() : modules_(), activeModule_(), index_(){};
 
 ModuleLoader::~ModuleLoader(){
     delete activeModule_;
@@ -173,7 +177,8 @@ void ModuleLoader::addModule(Core::Path modulePath){
 }
 
 void ModuleLoader::addModules(Core::Path modulesPath){
-    std::list<Path> paths{modulesPath.childFolders()};
+    index_.open(modulesPath, ApplicationSystem<DataSystem>::instance().runtimeDataPath().child("resource.index"));
+    std::list<Path> paths{index_.paths(ResourceType::MODULE)};
     for(auto i = paths.begin(); i != paths.end(); ++i){
         try{
             addModule(*i);
@@ -214,6 +219,10 @@ const Module *ModuleLoader::activeModule() const{
     return activeModule_;
 };
 
+const ResourceIndexer &ModuleLoader::index() const{
+    return index_;
+};
+
 const Module *ModuleLoader::loadModule(std::string moduleId){
     auto found = modules_.find(moduleId);
     if(found == modules_.end()){
@@ -226,7 +235,7 @@ const Module *ModuleLoader::loadModule(std::string moduleId){
             Path modulePath = (*i)->path;
             Path labelPath = modulePath.child("language_labels");
             if(labelPath.fileExists()){
-                std::ifstream input;
+                Core::FileInput input;
                 labelPath.openFile(input);
                 try{
                     languageLabels.load(input);
@@ -285,25 +294,100 @@ const std::list<Path> &Module::paths() const{
 
 ModuleResources::ModuleResources(const Module& module, const Language* language) : module_(module), language_(language){};
 
-void ModuleResources::load(Core::Path relativePath, Core::StringBundle& bundle) {
+std::list<Path> ModuleResources::sources(Core::Path relativePath) const{
     std::list<std::string> suffixes;
     const Language *language = language_;
     while(language){
-        suffixes.push_front(std::string{"_"}+language_->id());
+        suffixes.push_front(std::string{"_"}+language->id());
         language = language->parent();
     }
-    std::ifstream input;
     suffixes.push_front(std::string{""});
+    std::list<Path> result;
     for(auto i : module_.paths()){
+        std::string base{i.child(relativePath.data()).data()};
         for(auto j : suffixes){
-            Path path{i.data()+j};
-            if(path.fileExists()){
-                std::cout << "loading labels from file " << path << std::endl;
-                path.openFile(input);
-                bundle.load(input);
-            }
+            result.push_back(Path{base+j});
+        }
+    }
+    return result;
+}
+
+std::uint64_t ModuleResources::stamp(const std::list<Path> &sources) const{
+    std::uint64_t result = 0;
+    for(auto source : sources){
+        Core::FileStatus status = source.status();
+        result = Core::mixHash(result ^ Core::hash(source.data()), status.exists ? status.size : ~0ULL);
+        result = Core::mixHash(result, static_cast<std::uint64_t>(status.modified));
+        result = Core::mixHash(result, static_cast<std::uint64_t>(status.modifiedNanoseconds));
+    }
+    return result;
+}
+
+Path ModuleResources::compiledPath(Core::Path relativePath) const{
+    Path folder{ApplicationSystem<DataSystem>::instance().runtimeDataPath().child("bundles")};
+    folder.createFolder();
+    folder = folder.child(module_.id());
+    folder.createFolder();
+    std::string name{relativePath.data()};
+    std::replace(name.begin(), name.end(), '/', '.');
+    return folder.child(name+"_"+(language_ ? language_->id() : std::string{"default"})+".bundle");
+}
+
+void ModuleResources::parse(const std::list<Path> &sources, Core::StringBundle &bundle) const{
+    for(auto path : sources){
+        if(path.fileExists()){
+            std::cout << "loading labels from file " << path << std::endl;
+            Core::FileInput input;
+            path.openFile(input);
+            bundle.load(input);
         }
     }
 }
 
+void ModuleResources::write(const Core::StringBundle &bundle, Core::Path target, std::uint64_t stamp) const{
+    Path temporary{target.data()+".tmp"};
+    std::ofstream output;
+    if(temporary.openFile(output)){
+        bundle.write(output, stamp);
+        output.close();
+        if(std::rename(temporary.data().c_str(), target.data().c_str()) != 0){
+            throw ModuleException{Core::toString("unable to replace compiled bundle '", target.data(), "'")};
+        }
+    }else{
+        throw ModuleException{Core::toString("unable to write compiled bundle '", target.data(), "'")};
+    }
+}
 
+Path ModuleResources::compile(Core::Path relativePath) const{
+    std::list<Path> files{sources(relativePath)};
+    Path target{compiledPath(relativePath)};
+    Core::StringBundle bundle;
+    parse(files, bundle);
+    write(bundle, target, stamp(files));
+    return target;
+}
+
+void ModuleResources::compileAll(const Module &module, Core::Path relativePath){
+    for(auto language : module.languages()){
+        ModuleResources{module, language}.compile(relativePath);
+    }
+}
+
+void ModuleResources::load(Core::Path relativePath, Core::StringBundle& bundle) {
+    std::list<Path> files{sources(relativePath)};
+    std::uint64_t sourceStamp = stamp(files);
+    Path target{compiledPath(relativePath)};
+    if(bundle.map(target, sourceStamp)){
+        std::cout << "mapped compiled labels from file " << target << std::endl;
+        return;
+    }
+    // the compiled file holds this module's labels only, whatever the bundle holds already
+    Core::StringBundle compiled;
+    parse(files, compiled);
+    try{
+        write(compiled, target, sourceStamp);
+    }catch(std::exception &e){
+        std::cout << "unable to compile labels: " << e.what() << std::endl;
+    }
+    bundle.merge(compiled);
+}
@@ -11,11 +11,13 @@
 #include "Language.h"
 #include "Path.h"
 #include "StringBundle.h"
+#include "ResourceIndexer.h"
 
 #include <string>
 #include <map>
 #include <stdexcept>
 #include <set>
+#include <cstdint>
 
 namespace Game{
     
@@ -76,9 +78,23 @@ namespace Game{
         
         void load(Core::Path relativePath, Core::StringBundle &bundle);
         
+        Core::Path compile(Core::Path relativePath) const;
+        
+        static void compileAll(const Module &module, Core::Path relativePath);
+        
     private:
         const Module &module_;
         const Core::Language *language_;
+        
+        std::list<Core::Path> sources(Core::Path relativePath) const;
+        
+        std::uint64_t stamp(const std::list<Core::Path> &sources) const;
+        
+        Core::Path compiledPath(Core::Path relativePath) const;
+        
+        void parse(const std::list<Core::Path> &sources, Core::StringBundle &bundle) const;
+        
+        void write(const Core::StringBundle &bundle, Core::Path target, std::uint64_t stamp) const;
    
         ModuleResources(const ModuleResources &) = delete;
         ModuleResources &operator=(const ModuleResources &) = delete;
@@ -100,6 +116,8 @@ namespace Game{
         
         const Module *activeModule() const;
         
+        const ResourceIndexer &index() const;
+        
         ~ModuleLoader();
     private:
         
@@ -107,6 +125,8 @@ namespace Game{
         
         std::map<std::string, const ModuleDescriptor *> modules_;
         
+        ResourceIndexer index_;
+        
         void readModuleDescriptor(Core::Path modulePath, ModuleDescriptor &descriptor) const;
         
         std::list<const ModuleDescriptor *> dependencies(std::string moduleId) const;
@@ -6,15 +6,25 @@
 
 using namespace Game;
 
-const Scalar RADIAL_MAX = atan(1.)*4;
-
-
 bool Game::attach(OrbitalSystem *system, OrbitingBody *body, Orbit *orbit) {
     if(system && body && orbit &&(body->orbit_ == nullptr) && (system->orbits_.find(orbit) == system->orbits_.end()) && !(*orbit)){
+        OrbitEngine &engine = system->rootEngine();
+        OrbitEngine::Id id = orbit->insert(engine, system->orbitId_);
+        if(id == OrbitEngine::NONE){
+            return false;
+        }
         system->orbits_.insert(orbit);
         body->orbit_ = orbit;
         orbit->system_ = system;
         orbit->body_ = body;
+        body->engine_ = &engine;
+        body->orbitId_ = id;
+        OrbitalSystem *subsystem = dynamic_cast<OrbitalSystem *>(body);
+        if(subsystem && subsystem->ownEngine_){
+            // the subsystem was a root with orbits of its own
+            OrbitalSystem::move(subsystem, *subsystem->ownEngine_, engine);
+            subsystem->ownEngine_.reset();
+        }
         return true;
     }else{
         return false;
@@ -23,6 +33,16 @@ bool Game::attach(OrbitalSystem *system, OrbitingBody *body, Orbit *orbit) {
 
 bool Game::detach(OrbitingBody* body){
     if(body && body->orbit_ && *body->orbit_){
+        OrbitEngine &engine = *body->engine_;
+        OrbitEngine::Id id = body->orbitId_;
+        body->position_ = engine.position(id);
+        body->engine_ = nullptr;
+        body->orbitId_ = OrbitEngine::NONE;
+        OrbitalSystem *subsystem = dynamic_cast<OrbitalSystem *>(body);
+        if(subsystem && !subsystem->orbits_.empty()){
+            OrbitalSystem::move(subsystem, engine, subsystem->rootEngine());
+        }
+        engine.remove(id);
         body->orbit_->system_->orbits_.erase(body->orbit_);
         delete body->orbit_;
         body->orbit_ = nullptr;
@@ -44,12 +64,6 @@ OrbitalSystem* Orbit::system() const {
     return system_;
 }
 
-void Orbit::update() {
-    if(system_ && body_){
-        doUpdate();
-    }
-}
-
 Orbit::operator bool() const{
     return system_ && body_;
 }
@@ -58,11 +72,30 @@ bool Orbit::operator!() const {
     return !(system_ && body_);
 }
 
-Body::Body() : position(){}
+Body::Body() : position_(), engine_(), orbitId_(OrbitEngine::NONE){}
 
 
 Body::~Body() {}
 
+Position Body::position() const{
+    return engine_ ? engine_->position(orbitId_) : position_;
+}
+
+void Body::position(Position position){
+    if(engine_){
+        engine_->position(orbitId_, position);
+    }else{
+        position_ = position;
+    }
+}
+
+OrbitEngine *Body::engine() const{
+    return engine_;
+}
+
+OrbitEngine::Id Body::orbitId() const{
+    return orbitId_;
+}
 
 OrbitingBody::OrbitingBody() : orbit_(){
 }
@@ -75,10 +108,7 @@ Orbit* OrbitingBody::orbit() const {
     return orbit_;
 }
 
-void OrbitingBody::orbitUpdated() {
-}
-
-OrbitalSystem::OrbitalSystem() : orbits_(){}
+OrbitalSystem::OrbitalSystem() : orbits_(), ownEngine_(){}
 
 OrbitalSystem::~OrbitalSystem(){
     std::vector<OrbitingBody *> children{orbits_.size()};
@@ -90,26 +120,61 @@ OrbitalSystem::~OrbitalSystem(){
     }
 }
 
-void OrbitalSystem::orbitUpdated() {
-    OrbitingBody::orbitUpdated();
-    for(auto orbit : orbits_){
-        orbit->update();
+const std::set<Orbit *> &OrbitalSystem::orbits() const{
+    return orbits_;
+}
+
+OrbitEngine &OrbitalSystem::rootEngine(){
+    if(!engine_){
+        ownEngine_.reset(new OrbitEngine{});
+        engine_ = ownEngine_.get();
+        orbitId_ = engine_->addRoot(position_);
+    }
+    return *engine_;
+}
+
+void OrbitalSystem::move(OrbitalSystem *system, OrbitEngine &from, OrbitEngine &to){
+    for(auto orbit : system->orbits_){
+        OrbitingBody *body = orbit->body();
+        OrbitEngine::Id id = body->orbitId_;
+        body->orbitId_ = to.copy(from, id, system->orbitId_);
+        body->engine_ = &to;
+        OrbitalSystem *subsystem = dynamic_cast<OrbitalSystem *>(body);
+        if(subsystem){
+            move(subsystem, from, to);
+        }
+        from.remove(id);
+    }
+}
+
+void OrbitalSystem::updateOrbits(){
+    if(ownEngine_){
+        ownEngine_->update();
+    }
+}
+
+void OrbitalSystem::evaluateOrbits(Scalar time){
+    if(ownEngine_){
+        ownEngine_->evaluate(time);
     }
 }
 
 StaticOrbit::StaticOrbit(Position relativePosition) : Orbit(), relativePosition_(relativePosition){}
 
-void StaticOrbit::doUpdate(){
-    body_->position = system_->position + relativePosition_;
-};
+OrbitEngine::Id StaticOrbit::insert(OrbitEngine &engine, OrbitEngine::Id parent) const{
+    return engine.addStatic(parent, relativePosition_);
+}
 
 CircularOrbit::CircularOrbit(Scalar radius, Scalar radialSpeed, Scalar radialAngle)
 : Orbit(), radius_(radius), radialSpeed_(radialSpeed), radialAngle_(radialAngle){}
 
-void CircularOrbit::doUpdate(){
-    radialAngle_+=radialSpeed_;
-    if(radialAngle_ > angularMax()){
-        radialAngle_-=angularMax();
-    }
-    body_->position = Position{system_->position.x+cos(radialAngle_)*radius_, system_->position.y+sin(radialAngle_)*radius_};
-};
\ No newline at end of file
+OrbitEngine::Id CircularOrbit::insert(OrbitEngine &engine, OrbitEngine::Id parent) const{
+    return engine.addCircular(parent, radius_, radialSpeed_, radialAngle_);
+}
+
+EllipticalOrbit::EllipticalOrbit(Scalar semiMajorAxis, Scalar eccentricity, Scalar periapsisArgument, Scalar meanMotion, Scalar meanAnomaly)
+: Orbit(), semiMajorAxis_(semiMajorAxis), eccentricity_(eccentricity), periapsisArgument_(periapsisArgument), meanMotion_(meanMotion), meanAnomaly_(meanAnomaly){}
+
+OrbitEngine::Id EllipticalOrbit::insert(OrbitEngine &engine, OrbitEngine::Id parent) const{
+    return engine.addElliptical(parent, semiMajorAxis_, eccentricity_, periapsisArgument_, meanMotion_, meanAnomaly_);
+}
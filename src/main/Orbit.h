@@ -9,36 +9,65 @@
 #define	ORBIT_H
 
 #include "Graphics.h" 
+#include "OrbitEngine.h"
 
 #include <set>
+#include <memory>
 
 namespace Game{
     
+    class OrbitingBody;
+    
+    class OrbitalSystem;
+    
+    class Orbit;
+    
+    /*
+     * Position of a body, read from the orbit engine of its hierarchy once it
+     * is part of one
+     */
     class Body{
     public:
-        Position position;
-        
         Body();
         
         virtual ~Body();
+        
+        Position position() const;
+        
+        /*
+         * Moves the root of a hierarchy, or the offset of an orbiting body
+         * from its parent
+         */
+        void position(Position position);
+        
+        OrbitEngine *engine() const;
+        
+        OrbitEngine::Id orbitId() const;
+        
     private:
+        Position position_;
+        OrbitEngine *engine_;
+        OrbitEngine::Id orbitId_;
+        
+        friend class OrbitalSystem;
+        friend bool attach(OrbitalSystem *, OrbitingBody *, Orbit *);
+        friend bool detach(OrbitingBody *);
+        
         Body(const Body &) = delete;
         Body &operator=(const Body &) = delete;
     };
     
-    class OrbitingBody;
-    
-    class OrbitalSystem;
-    
-    class Orbit;
-    
     bool attach(OrbitalSystem *system, OrbitingBody *body, Orbit *orbit);
     
     bool detach(OrbitingBody *body);
     
+    /*
+     * Parameters of an orbit, moved into the orbit engine of the hierarchy
+     * when attached
+     */
     class Orbit{
     public:
-        ~Orbit();
+        virtual ~Orbit();
         
         OrbitalSystem *system() const;
         
@@ -48,13 +77,11 @@ namespace Game{
         
         operator bool() const;
         
-        void update();
-        
     protected:
         
         Orbit();
         
-        virtual void doUpdate() = 0;
+        virtual OrbitEngine::Id insert(OrbitEngine &engine, OrbitEngine::Id parent) const = 0;
         
         OrbitalSystem *system_;
         OrbitingBody *body_;
@@ -62,6 +89,7 @@ namespace Game{
         
         friend bool attach(OrbitalSystem *, OrbitingBody *, Orbit *);
         friend bool detach(OrbitingBody *);
+        friend class BodyStore;
         
         Orbit(const Orbit &) = delete;
         
@@ -73,7 +101,7 @@ namespace Game{
         StaticOrbit(Position relativePosition);
         
     protected:
-        void doUpdate();
+        OrbitEngine::Id insert(OrbitEngine &engine, OrbitEngine::Id parent) const;
         
     private:
         Position relativePosition_;
@@ -84,7 +112,7 @@ namespace Game{
         CircularOrbit(Scalar radius, Scalar radialSpeed, Scalar radialAngle = 0.);
         
     protected:
-        void doUpdate();
+        OrbitEngine::Id insert(OrbitEngine &engine, OrbitEngine::Id parent) const;
         
     private:
         Scalar radius_;
@@ -92,6 +120,25 @@ namespace Game{
         Scalar radialAngle_;
     };
     
+    /*
+     * Kepler ellipse with the parent in one focus, the mean anomaly is the
+     * one at the time of attaching
+     */
+    class EllipticalOrbit : public Orbit{
+    public:
+        EllipticalOrbit(Scalar semiMajorAxis, Scalar eccentricity, Scalar periapsisArgument, Scalar meanMotion, Scalar meanAnomaly = 0.);
+        
+    protected:
+        OrbitEngine::Id insert(OrbitEngine &engine, OrbitEngine::Id parent) const;
+        
+    private:
+        Scalar semiMajorAxis_;
+        Scalar eccentricity_;
+        Scalar periapsisArgument_;
+        Scalar meanMotion_;
+        Scalar meanAnomaly_;
+    };
+    
     class OrbitingBody : public Body{
     public:
         
@@ -100,8 +147,6 @@ namespace Game{
         ~OrbitingBody();
         
         Orbit *orbit() const;
-    protected:
-        virtual void orbitUpdated();
         
     private:
         Orbit *orbit_;
@@ -118,12 +163,27 @@ namespace Game{
         ~OrbitalSystem();
         
         const std::set<Orbit *> &orbits() const;
-    protected:
         
-        virtual void orbitUpdated();
+        /*
+         * Updates every orbit below this system, only roots own an engine
+         */
+        void updateOrbits();
+        
+        /*
+         * Moves every orbit below this system to the given time in ticks
+         */
+        void evaluateOrbits(Scalar time);
         
     private:
         std::set<Orbit*> orbits_;
+        std::unique_ptr<OrbitEngine> ownEngine_;
+        
+        OrbitEngine &rootEngine();
+        
+        /*
+         * Moves the orbits below system from one engine to the other
+         */
+        static void move(OrbitalSystem *system, OrbitEngine &from, OrbitEngine &to);
         
         friend bool attach(OrbitalSystem *, OrbitingBody *, Orbit *);
         friend bool detach(OrbitingBody *);
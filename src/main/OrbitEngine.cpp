@@ -0,0 +1,481 @@
+#include "OrbitEngine.h"
+#include "FastMath.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+using namespace Game;
+
+namespace {
+
+    /*
+     * Angle of an orbit at a time, reduced to -pi..pi so sinCos stays accurate
+     * for far away times
+     */
+    inline Scalar angleAt(Scalar phase, Scalar speed, Scalar time, Scalar full){
+        Scalar angle = phase + speed * time;
+        return angle - full * Core::roundNearest(angle / full);
+    }
+
+    std::atomic<std::uint64_t> layouts{0};
+
+    std::uint64_t nextLayout(){
+        return ++layouts;
+    }
+
+    template<typename T>
+    void permute(std::vector<T> &values, const std::vector<Game::OrbitEngine::Id> &order){
+        std::vector<T> result;
+        result.reserve(order.size());
+        for(auto i : order){
+            result.push_back(values[i]);
+        }
+        values.swap(result);
+    }
+
+}
+
+const OrbitEngine::Id OrbitEngine::NONE = 0xFFFFFFFF;
+
+const std::size_t OrbitEngine::DEFAULT_GRAIN = 4096;
+
+OrbitEngine::OrbitEngine() : dense_(), ids_(), freeIds_(), parent_(), radius_(), minorRadius_(), eccentricity_(), periapsisCos_(), periapsisSin_(), speed_(), phase_(), offsetX_(), offsetY_(), x_(), y_(), sine_(), cosine_(), angle_(), anomaly_(), rootTime_(), extent_(), end_(), heads_(), jobs_(), removed_(), eccentric_(), grain_(), ordered_(true), extentValid_(true), layout_(nextLayout()), time_(){
+}
+
+OrbitEngine::Id OrbitEngine::index(Id id) const{
+    return id < dense_.size() ? dense_[id] : NONE;
+}
+
+OrbitEngine::Id OrbitEngine::insert(Id parent, Scalar radius, Scalar eccentricity, Scalar periapsisCos, Scalar periapsisSin, Scalar speed, Scalar phase, Position offset){
+    Id parentIndex = index(parent);
+    if((parent != NONE && parentIndex == NONE) || !(eccentricity >= 0. && eccentricity < 1.)){
+        return NONE;
+    }
+    Id id;
+    if(freeIds_.empty()){
+        id = static_cast<Id>(dense_.size());
+        dense_.push_back(NONE);
+    }else{
+        id = freeIds_.back();
+        freeIds_.pop_back();
+    }
+    // appending keeps parents before children
+    Id entry = static_cast<Id>(ids_.size());
+    dense_[id] = entry;
+    ids_.push_back(id);
+    parent_.push_back(parentIndex);
+    radius_.push_back(radius);
+    minorRadius_.push_back(radius * std::sqrt(1. - eccentricity * eccentricity));
+    eccentricity_.push_back(eccentricity);
+    periapsisCos_.push_back(periapsisCos);
+    periapsisSin_.push_back(periapsisSin);
+    speed_.push_back(speed);
+    phase_.push_back(phase);
+    offsetX_.push_back(offset.x);
+    offsetY_.push_back(offset.y);
+    x_.push_back(0.);
+    y_.push_back(0.);
+    rootTime_.push_back(time_);
+    extent_.push_back(0.);
+    if(eccentricity != 0.){
+        ++eccentric_;
+    }
+    place(entry);
+    ordered_ = false;
+    layout_ = nextLayout();
+    return id;
+}
+
+OrbitEngine::Id OrbitEngine::addRoot(Position position){
+    return insert(NONE, 0., 0., 1., 0., 0., 0., position);
+}
+
+OrbitEngine::Id OrbitEngine::addStatic(Id parent, Position offset){
+    return insert(parent, 0., 0., 1., 0., 0., 0., offset);
+}
+
+OrbitEngine::Id OrbitEngine::addCircular(Id parent, Scalar radius, Scalar speed, Scalar angle){
+    return insert(parent, radius, 0., 1., 0., speed, angle - speed * time_, Position{});
+}
+
+OrbitEngine::Id OrbitEngine::addElliptical(Id parent, Scalar semiMajorAxis, Scalar eccentricity, Scalar periapsisArgument, Scalar meanMotion, Scalar meanAnomaly){
+    return insert(parent, semiMajorAxis, eccentricity, std::cos(periapsisArgument), std::sin(periapsisArgument), meanMotion, meanAnomaly - meanMotion * time_, Position{});
+}
+
+OrbitEngine::Id OrbitEngine::copy(const OrbitEngine &engine, Id id, Id parent){
+    Id i = engine.index(id);
+    if(i == NONE){
+        return NONE;
+    }
+    // same angle now as in the other engine at its time
+    Scalar phase = engine.phase_[i] + engine.speed_[i] * (engine.time_ - time_);
+    return insert(parent, engine.radius_[i], engine.eccentricity_[i], engine.periapsisCos_[i], engine.periapsisSin_[i], engine.speed_[i], phase, Position{engine.offsetX_[i], engine.offsetY_[i]});
+}
+
+void OrbitEngine::remove(Id id){
+    Id i = index(id);
+    if(i != NONE){
+        dense_[id] = NONE;
+        ids_[i] = NONE;
+        freeIds_.push_back(id);
+        ++removed_;
+        ordered_ = false;
+        layout_ = nextLayout();
+    }
+}
+
+void OrbitEngine::order(){
+    const Id count = static_cast<Id>(ids_.size());
+    // children of each orbit in dense order, roots as children of count
+    std::vector<Id> first(count + 3, 0);
+    // orphans keep the time their old root was evaluated at
+    std::vector<Scalar> evaluated(count);
+    for(Id i = 0; i < count; ++i){
+        evaluated[i] = parent_[i] == NONE ? rootTime_[i] : evaluated[parent_[i]];
+    }
+    eccentric_ = 0;
+    for(Id i = 0; i < count; ++i){
+        if(ids_[i] == NONE){
+            continue;
+        }
+        Id parent = parent_[i];
+        if(parent != NONE && ids_[parent] == NONE){
+            parent = NONE;
+            radius_[i] = minorRadius_[i] = eccentricity_[i] = speed_[i] = phase_[i] = 0.;
+            offsetX_[i] = x_[i];
+            offsetY_[i] = y_[i];
+            rootTime_[i] = evaluated[i];
+        }
+        if(eccentricity_[i] != 0.){
+            ++eccentric_;
+        }
+        parent_[i] = parent;
+        ++first[(parent == NONE ? count : parent) + 2];
+    }
+    for(Id i = 2; i < count + 3; ++i){
+        first[i] += first[i - 1];
+    }
+    std::vector<Id> children(count - removed_);
+    for(Id i = 0; i < count; ++i){
+        if(ids_[i] != NONE){
+            children[first[(parent_[i] == NONE ? count : parent_[i]) + 1]++] = i;
+        }
+    }
+    // depth first, so every subtree ends up in one range
+    std::vector<Id> order;
+    order.reserve(children.size());
+    std::vector<Id> stack{count};
+    while(!stack.empty()){
+        Id i = stack.back();
+        stack.pop_back();
+        if(i != count){
+            order.push_back(i);
+        }
+        for(Id c = first[i + 1]; c > first[i]; --c){
+            stack.push_back(children[c - 1]);
+        }
+    }
+    std::vector<Id> moved(count, NONE);
+    for(Id i = 0; i < order.size(); ++i){
+        moved[order[i]] = i;
+    }
+    permute(ids_, order);
+    permute(parent_, order);
+    for(auto vector : {&radius_, &minorRadius_, &eccentricity_, &periapsisCos_, &periapsisSin_, &speed_, &phase_, &offsetX_, &offsetY_, &x_, &y_, &rootTime_}){
+        permute(*vector, order);
+    }
+    const Id size = static_cast<Id>(order.size());
+    extent_.resize(size);
+    end_.assign(size, 1);
+    for(Id i = size; i-- > 0;){
+        if(parent_[i] != NONE){
+            parent_[i] = moved[parent_[i]];
+            end_[parent_[i]] += end_[i];
+        }
+        end_[i] += i;
+        dense_[ids_[i]] = i;
+    }
+    removed_ = 0;
+    ordered_ = true;
+    layout_ = nextLayout();
+    extentValid_ = false;
+    grain_ = 0;
+}
+
+void OrbitEngine::split(Id i, std::size_t grain){
+    if(end_[i] - i <= grain){
+        // neighbouring small subtrees share a job
+        if(!jobs_.empty() && jobs_.back().end == i && end_[i] - jobs_.back().begin <= grain){
+            jobs_.back().end = end_[i];
+        }else{
+            jobs_.push_back(Job{i, end_[i]});
+        }
+    }else{
+        heads_.push_back(i);
+        for(Id child = i + 1; child < end_[i]; child = end_[child]){
+            split(child, grain);
+        }
+    }
+}
+
+OrbitEngine::Id OrbitEngine::root(Id i) const{
+    while(parent_[i] != NONE){
+        i = parent_[i];
+    }
+    return i;
+}
+
+void OrbitEngine::place(Id i){
+    Position position = relative(i, rootTime_[root(i)]);
+    x_[i] = position.x;
+    y_[i] = position.y;
+    if(parent_[i] != NONE){
+        x_[i] += x_[parent_[i]];
+        y_[i] += y_[parent_[i]];
+    }
+}
+
+Position OrbitEngine::relative(Id i, Scalar time) const{
+    Scalar anomaly = Core::eccentricAnomaly(angleAt(phase_[i], speed_[i], time, angularMax()), eccentricity_[i]);
+    Scalar sine, cosine;
+    Core::sinCos(anomaly, sine, cosine);
+    Scalar u = radius_[i] * (cosine - eccentricity_[i]);
+    Scalar v = minorRadius_[i] * sine;
+    return Position{offsetX_[i] + (periapsisCos_[i] * u - periapsisSin_[i] * v), offsetY_[i] + (periapsisSin_[i] * u + periapsisCos_[i] * v)};
+}
+
+void OrbitEngine::update(){
+    evaluate(time_ + 1.);
+}
+
+void OrbitEngine::evaluate(Scalar time){
+    prepare(time);
+    for(const Job &job : jobs_){
+        evaluate(job);
+    }
+}
+
+void OrbitEngine::prepare(Scalar time, std::size_t grain){
+    if(!ordered_){
+        order();
+    }
+    grain = std::max<std::size_t>(grain, 1);
+    if(grain != grain_){
+        grain_ = grain;
+        heads_.clear();
+        jobs_.clear();
+        for(Id root = 0; root < ids_.size(); root = end_[root]){
+            split(root, grain);
+        }
+    }
+    for(Id root = 0; root < ids_.size(); root = end_[root]){
+        rootTime_[root] = time;
+    }
+    start(time);
+}
+
+void OrbitEngine::prepare(Scalar time, const std::vector<Id> &roots, std::size_t grain){
+    if(!ordered_){
+        order();
+    }
+    grain = std::max<std::size_t>(grain, 1);
+    // replaces the split of all roots
+    grain_ = 0;
+    heads_.clear();
+    jobs_.clear();
+    for(Id id : roots){
+        Id i = index(id);
+        // roots already at the time, given twice or not, are left alone
+        if(i != NONE && parent_[i] == NONE && rootTime_[i] != time){
+            rootTime_[i] = time;
+            split(i, grain);
+        }
+    }
+    start(time);
+}
+
+void OrbitEngine::start(Scalar time){
+    time_ = time;
+    const std::size_t count = ids_.size();
+    angle_.resize(count);
+    anomaly_.resize(eccentric_ ? count : 0);
+    sine_.resize(count);
+    cosine_.resize(count);
+    for(Id head : heads_){
+        place(head);
+    }
+}
+
+const std::vector<OrbitEngine::Job> &OrbitEngine::jobs() const{
+    return jobs_;
+}
+
+void OrbitEngine::evaluate(const Job &job){
+    const std::size_t count = job.end - job.begin;
+    const Scalar full = angularMax();
+    const Scalar time = time_;
+    Scalar *angle = angle_.data() + job.begin;
+    const Scalar *phase = phase_.data() + job.begin;
+    const Scalar *speed = speed_.data() + job.begin;
+#pragma omp simd
+    for(std::size_t i = 0; i < count; ++i){
+        angle[i] = angleAt(phase[i], speed[i], time, full);
+    }
+    Scalar *sine = sine_.data() + job.begin;
+    Scalar *cosine = cosine_.data() + job.begin;
+    const Scalar *eccentricity = eccentricity_.data() + job.begin;
+    if(eccentric_){
+        // the solver returns circles' mean anomalies unchanged
+        Scalar *anomaly = anomaly_.data() + job.begin;
+        Core::eccentricAnomaly(angle, eccentricity, anomaly, count);
+        Core::sinCos(anomaly, sine, cosine, count);
+    }else{
+        Core::sinCos(angle, sine, cosine, count);
+    }
+    Scalar *x = x_.data() + job.begin;
+    Scalar *y = y_.data() + job.begin;
+    const Scalar *radius = radius_.data() + job.begin;
+    const Scalar *minorRadius = minorRadius_.data() + job.begin;
+    const Scalar *periapsisCos = periapsisCos_.data() + job.begin;
+    const Scalar *periapsisSin = periapsisSin_.data() + job.begin;
+    const Scalar *offsetX = offsetX_.data() + job.begin;
+    const Scalar *offsetY = offsetY_.data() + job.begin;
+#pragma omp simd
+    for(std::size_t i = 0; i < count; ++i){
+        Scalar u = radius[i] * (cosine[i] - eccentricity[i]);
+        Scalar v = minorRadius[i] * sine[i];
+        x[i] = offsetX[i] + (periapsisCos[i] * u - periapsisSin[i] * v);
+        y[i] = offsetY[i] + (periapsisSin[i] * u + periapsisCos[i] * v);
+    }
+    // parents are either earlier in the job or placed by prepare()
+    const Id *parent = parent_.data();
+    Scalar *allX = x_.data();
+    Scalar *allY = y_.data();
+    for(Id i = job.begin; i < job.end; ++i){
+        if(parent[i] != NONE){
+            allX[i] += allX[parent[i]];
+            allY[i] += allY[parent[i]];
+        }
+    }
+}
+
+Scalar OrbitEngine::time() const{
+    return time_;
+}
+
+Scalar OrbitEngine::time(Id id) const{
+    Id i = index(id);
+    return i == NONE ? time_ : rootTime_[root(i)];
+}
+
+void OrbitEngine::rebase(Scalar time){
+    const Scalar shift = time - time_;
+    const std::size_t count = phase_.size();
+    for(std::size_t i = 0; i < count; ++i){
+        phase_[i] -= speed_[i] * shift;
+        rootTime_[i] += shift;
+    }
+    time_ = time;
+    layout_ = nextLayout();
+}
+
+Position OrbitEngine::position(Id id) const{
+    Id i = index(id);
+    return i == NONE ? Position{} : Position{x_[i], y_[i]};
+}
+
+void OrbitEngine::positions(std::vector<Position> &positions) const{
+    positions.assign(dense_.size(), Position{});
+    for(Id i = 0; i < ids_.size(); ++i){
+        if(ids_[i] != NONE){
+            positions[ids_[i]] = Position{x_[i], y_[i]};
+        }
+    }
+}
+
+void OrbitEngine::roots(std::vector<Id> &roots, std::vector<Scalar> &times) const{
+    roots.assign(dense_.size(), NONE);
+    times.assign(dense_.size(), time_);
+    // parents come first, so each root is known before its children
+    for(Id i = 0; i < ids_.size(); ++i){
+        const Id id = ids_[i];
+        if(id == NONE){
+            continue;
+        }
+        const Id parent = parent_[i];
+        if(parent == NONE || ids_[parent] == NONE){
+            // orphans are roots from the next order() on
+            roots[id] = id;
+            times[id] = rootTime_[root(i)];
+        }else{
+            roots[id] = roots[ids_[parent]];
+        }
+    }
+}
+
+void OrbitEngine::evaluated(std::vector<Id> &ids) const{
+    for(Id head : heads_){
+        ids.push_back(ids_[head]);
+    }
+    for(const Job &job : jobs_){
+        for(Id i = job.begin; i < job.end; ++i){
+            ids.push_back(ids_[i]);
+        }
+    }
+}
+
+Position OrbitEngine::position(Id id, Scalar time) const{
+    Position result;
+    for(Id i = index(id); i != NONE; i = parent_[i]){
+        Position relative = this->relative(i, time);
+        result.x += relative.x;
+        result.y += relative.y;
+    }
+    return result;
+}
+
+void OrbitEngine::position(Id id, Position position){
+    Id i = index(id);
+    if(i != NONE){
+        offsetX_[i] = position.x;
+        offsetY_[i] = position.y;
+        extentValid_ = false;
+        place(i);
+        layout_ = nextLayout();
+    }
+}
+
+OrbitEngine::Id OrbitEngine::parent(Id id) const{
+    Id i = index(id);
+    return i == NONE || parent_[i] == NONE ? NONE : ids_[parent_[i]];
+}
+
+std::size_t OrbitEngine::size() const{
+    return ids_.size() - removed_;
+}
+
+std::uint64_t OrbitEngine::layout() const{
+    return layout_;
+}
+
+Scalar OrbitEngine::extent(Id root){
+    if(!ordered_){
+        order();
+    }
+    if(!extentValid_){
+        const Id count = static_cast<Id>(ids_.size());
+        // farthest each orbit gets from its root
+        std::vector<Scalar> reach(count);
+        for(Id r = 0; r < count; r = end_[r]){
+            reach[r] = extent_[r] = 0.;
+            for(Id i = r + 1; i < end_[r]; ++i){
+                reach[i] = reach[parent_[i]] + radius_[i] * (1. + eccentricity_[i]) + std::hypot(offsetX_[i], offsetY_[i]);
+                extent_[r] = std::max(extent_[r], reach[i]);
+            }
+        }
+        extentValid_ = true;
+    }
+    Id i = index(root);
+    return i == NONE ? 0. : extent_[i];
+}
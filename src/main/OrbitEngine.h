@@ -0,0 +1,236 @@
+/*
+ * File:   OrbitEngine.h
+ * Author: hans
+ *
+ * Created on October 19, 2026, 10:05 PM
+ */
+
+#ifndef ORBITENGINE_H
+#define	ORBITENGINE_H
+
+#include "Graphics.h"
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace Game{
+
+    /*
+     * Orbits of one hierarchy of bodies in flat arrays, parents always stored
+     * before their children, so all positions are updated in two linear
+     * sweeps: one computing each body's offset from its parent, one adding
+     * the parent positions. Before evaluating, the arrays are sorted so every
+     * subtree is a contiguous range, which lets large hierarchies be split
+     * into jobs of whole subtrees.
+     *
+     * Each root and its subtree may be evaluated on its own, so one engine
+     * holds many independent systems; the positions of a subtree are those
+     * of the time its root was last evaluated at.
+     *
+     * Every orbit is a Kepler ellipse with its parent's position, shifted by a
+     * fixed offset, in one focus; circles have a zero eccentricity, static
+     * orbits a zero semi-major axis, roots also have no parent. Mean anomalies
+     * are a closed function of the simulation time, measured in ticks, so any
+     * time is evaluated at the cost of a single tick.
+     * Ids stay valid until removed, the dense order is private.
+     */
+    class OrbitEngine{
+    public:
+        using Id = std::uint32_t;
+
+        static const Id NONE;
+
+        static const std::size_t DEFAULT_GRAIN;
+
+        /*
+         * Orbits evaluated together: one or more whole subtrees in dense order
+         */
+        struct Job{
+            Id begin;
+            Id end;
+        };
+
+        OrbitEngine();
+
+        Id addRoot(Position position);
+
+        Id addStatic(Id parent, Position offset);
+
+        /*
+         * Adds a circular orbit at the given angle at the current time, speed
+         * is in radians per tick
+         */
+        Id addCircular(Id parent, Scalar radius, Scalar speed, Scalar angle);
+
+        /*
+         * Adds an elliptical orbit at the given mean anomaly at the current
+         * time, the mean motion is in radians per tick and the periapsis
+         * argument is measured from the x axis. Fails for eccentricities
+         * outside 0..1.
+         */
+        Id addElliptical(Id parent, Scalar semiMajorAxis, Scalar eccentricity, Scalar periapsisArgument, Scalar meanMotion, Scalar meanAnomaly);
+
+        /*
+         * Adds a copy of an orbit of another engine below parent
+         */
+        Id copy(const OrbitEngine &engine, Id id, Id parent);
+
+        /*
+         * Children of a removed orbit become roots at their current position
+         */
+        void remove(Id id);
+
+        /*
+         * Advances the time by one tick and updates all positions
+         */
+        void update();
+
+        /*
+         * Updates all positions to the given time, which may lie anywhere in
+         * the past or future
+         */
+        void evaluate(Scalar time);
+
+        /*
+         * Sets the time for evaluate(Job), splits the orbits into jobs of at
+         * most grain orbits and places the few orbits above those jobs. The
+         * split only depends on the hierarchy and grain, never on who runs
+         * the jobs.
+         */
+        void prepare(Scalar time, std::size_t grain = DEFAULT_GRAIN);
+
+        /*
+         * Like prepare(time, grain) for the subtrees of the given roots only,
+         * all other orbits keep their positions; ids that are not roots are
+         * skipped
+         */
+        void prepare(Scalar time, const std::vector<Id> &roots, std::size_t grain = DEFAULT_GRAIN);
+
+        const std::vector<Job> &jobs() const;
+
+        /*
+         * Updates the positions of one job of the last prepare(), different
+         * jobs may be evaluated concurrently
+         */
+        void evaluate(const Job &job);
+
+        Scalar time() const;
+
+        /*
+         * Time the stored position of an orbit was evaluated at
+         */
+        Scalar time(Id id) const;
+
+        /*
+         * Moves the clock to time, leaving every orbit where it is
+         */
+        void rebase(Scalar time);
+
+        Position position(Id id) const;
+
+        /*
+         * Copies all positions, indexed by id, orbits removed at {0, 0}
+         */
+        void positions(std::vector<Position> &positions) const;
+
+        /*
+         * Copies the root of every orbit, NONE for removed ones, and the time
+         * every root was last evaluated at, both indexed by id
+         */
+        void roots(std::vector<Id> &roots, std::vector<Scalar> &times) const;
+
+        /*
+         * Appends the ids of all orbits the last prepare() changed
+         */
+        void evaluated(std::vector<Id> &ids) const;
+
+        /*
+         * Position of a single orbit at the given time, leaving the stored
+         * positions unchanged
+         */
+        Position position(Id id, Scalar time) const;
+
+        /*
+         * Moves a root, or shifts the offset of an orbit from its parent
+         */
+        void position(Id id, Position position);
+
+        Id parent(Id id) const;
+
+        /*
+         * Radius around a root that no orbit of its subtree ever leaves
+         */
+        Scalar extent(Id root);
+
+        std::size_t size() const;
+
+        /*
+         * Changes whenever orbits are added, removed or moved, or the clock
+         * is rebased, but not by evaluating; unique among all engines
+         */
+        std::uint64_t layout() const;
+
+    private:
+        std::vector<Id> dense_;
+        std::vector<Id> ids_;
+        std::vector<Id> freeIds_;
+        std::vector<Id> parent_;
+        std::vector<Scalar> radius_;
+        std::vector<Scalar> minorRadius_;
+        std::vector<Scalar> eccentricity_;
+        std::vector<Scalar> periapsisCos_;
+        std::vector<Scalar> periapsisSin_;
+        std::vector<Scalar> speed_;
+        std::vector<Scalar> phase_;
+        std::vector<Scalar> offsetX_;
+        std::vector<Scalar> offsetY_;
+        std::vector<Scalar> x_;
+        std::vector<Scalar> y_;
+        std::vector<Scalar> sine_;
+        std::vector<Scalar> cosine_;
+        std::vector<Scalar> angle_;
+        std::vector<Scalar> anomaly_;
+        std::vector<Scalar> rootTime_;
+        std::vector<Scalar> extent_;
+        std::vector<Id> end_;
+        std::vector<Id> heads_;
+        std::vector<Job> jobs_;
+        std::size_t removed_;
+        std::size_t eccentric_;
+        std::size_t grain_;
+        bool ordered_;
+        bool extentValid_;
+        std::uint64_t layout_;
+        Scalar time_;
+
+        Id insert(Id parent, Scalar radius, Scalar eccentricity, Scalar periapsisCos, Scalar periapsisSin, Scalar speed, Scalar phase, Position offset);
+
+        Id index(Id id) const;
+
+        void order();
+
+        void split(Id index, std::size_t grain);
+
+        Id root(Id index) const;
+
+        void place(Id index);
+
+        /*
+         * Sets the time and places the heads of the jobs
+         */
+        void start(Scalar time);
+
+        /*
+         * Position relative to the parent at the given time
+         */
+        Position relative(Id index, Scalar time) const;
+
+        OrbitEngine(const OrbitEngine &) = delete;
+        OrbitEngine &operator=(const OrbitEngine &) = delete;
+    };
+
+}
+
+#endif	/* ORBITENGINE_H */
+
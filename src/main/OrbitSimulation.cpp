@@ -0,0 +1,511 @@
+#include "OrbitSimulation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace Game;
+
+namespace {
+
+    // systems this many view sizes beyond the view are still updated at the reduced rate
+    const Scalar NEAR_MARGIN = 1.;
+
+    // systems smaller on screen than this, in projected units, are not worth every tick in the strategic view
+    const Scalar MIN_STRATEGIC_EXTENT = 0.01;
+
+    // like GalaxyIndex, the root of the quadtree grows for larger maps
+    const Scalar ROOT_SIZE = 4e9;
+
+    const Scalar MIN_CELL_SIZE = 1e3;
+
+    /*
+     * Follows ViewPoint::loadProjectionMatrix: the view shows the world
+     * within 1 / zoom of -position / zoom
+     */
+    OrbitDetail classify(const ViewPoint &view, Position center, Scalar extent){
+        const Scalar half = 1. / view.zoom;
+        Scalar dx = std::max(std::fabs(center.x + view.position.x * half) - half, 0.);
+        Scalar dy = std::max(std::fabs(center.y + view.position.y * half) - half, 0.);
+        Scalar distance = std::hypot(dx, dy) - extent;
+        if(distance > 2. * half * NEAR_MARGIN){
+            return OrbitDetail::ON_DEMAND;
+        }else if(distance > 0. || (view.mode == ViewMode::STRATEGIC && extent * view.zoom < MIN_STRATEGIC_EXTENT)){
+            return OrbitDetail::REDUCED;
+        }else{
+            return OrbitDetail::FULL;
+        }
+    }
+
+}
+
+const unsigned OrbitSimulation::REDUCED_INTERVAL = 8;
+
+const std::uint64_t OrbitSimulation::HISTORY = 8;
+
+CapturedOrbits::CapturedOrbits() : engine(), generation(), positions(), previous(), roots(), times(), previousTimes(){
+}
+
+OrbitPositions::OrbitPositions() : time(), sequence(), engines(){
+}
+
+const CapturedOrbits *OrbitPositions::find(const OrbitEngine *engine) const{
+    auto found = std::lower_bound(engines.begin(), engines.end(), engine, [](const CapturedOrbits &orbits, const OrbitEngine *engine){
+        return orbits.engine < engine;
+    });
+    return found != engines.end() && found->engine == engine ? &*found : nullptr;
+}
+
+const Position *OrbitPositions::find(const OrbitEngine *engine, OrbitEngine::Id id) const{
+    const CapturedOrbits *orbits = find(engine);
+    return orbits && id < orbits->positions.size() ? &orbits->positions[id] : nullptr;
+}
+
+OrbitFrame::OrbitFrame(const OrbitPositions *positions, Scalar fraction) : positions_(positions), fraction_(fraction){
+}
+
+Position OrbitFrame::position(const Body &body) const{
+    if(!positions_ || !body.engine()){
+        return body.position();
+    }
+    return position(body.engine(), body.orbitId());
+}
+
+Position OrbitFrame::position(const OrbitEngine *engine, OrbitEngine::Id id) const{
+    if(!positions_){
+        return engine->position(id);
+    }
+    const CapturedOrbits *orbits = positions_->find(engine);
+    if(!orbits || id >= orbits->positions.size()){
+        // attached after the capture, not readable while simulating
+        return Position{};
+    }
+    const Position &current = orbits->positions[id];
+    const OrbitEngine::Id root = orbits->roots[id];
+    // systems updated at a reduced rate jump rather than crawl
+    if(root == OrbitEngine::NONE || orbits->times[root] != positions_->time || orbits->previousTimes[root] != positions_->time - 1.){
+        return current;
+    }
+    const Position &previous = orbits->previous[id];
+    return Position{previous.x + (current.x - previous.x) * fraction_, previous.y + (current.y - previous.y) * fraction_};
+}
+
+OrbitSimulation::OrbitSimulation(Core::ThreadPool &pool, std::size_t grain) : pool_(pool), grain_(grain), systems_(), systemSites_(), systemIndex_(), roots_(), rootIndex_(), batches_(), batchIndex_(), jobs_(), sites_(ROOT_SIZE, MIN_CELL_SIZE), tracked_(), captured_(), history_(HISTORY), captureEngines_(), copied_(), generation_(), view_(Position{}, 1., ViewMode::TACTICAL), hasView_(false), time_(){
+}
+
+OrbitEngine *OrbitSimulation::engine(OrbitalSystem *system){
+    // systems attached since being added are moved by their new root
+    return system->orbit() == nullptr ? system->engine() : nullptr;
+}
+
+OrbitEngine *OrbitSimulation::engine(const Site &site, OrbitEngine::Id &root){
+    if(site.system){
+        root = site.system->orbitId();
+        return engine(site.system);
+    }
+    root = site.root;
+    return site.engine;
+}
+
+Core::Bounds<Scalar> OrbitSimulation::bounds(const Site &site){
+    OrbitEngine::Id root;
+    OrbitEngine *engine = OrbitSimulation::engine(site, root);
+    if(!engine){
+        return Core::Bounds<Scalar>{};
+    }
+    Position center = engine->position(root);
+    Scalar extent = engine->extent(root);
+    return Core::Bounds<Scalar>{center.x - extent, center.x + extent, center.y - extent, center.y + extent};
+}
+
+void OrbitSimulation::add(OrbitalSystem *system){
+    if(system && systemIndex_.emplace(system, systems_.size()).second){
+        systems_.push_back(system);
+        if(OrbitEngine *engine = this->engine(system)){
+            align(engine);
+        }
+        Site site{system, nullptr, OrbitEngine::NONE};
+        systemSites_.push_back(sites_.insert(site, bounds(site)));
+    }
+}
+
+void OrbitSimulation::add(OrbitEngine *engine, OrbitEngine::Id root){
+    if(!engine){
+        return;
+    }
+    auto found = rootIndex_.emplace(engine, roots_.size());
+    if(found.second){
+        roots_.push_back(Roots{engine, {}, {}});
+        align(engine);
+    }
+    Roots &roots = roots_[found.first->second];
+    if(roots.index.emplace(root, roots.ids.size()).second){
+        roots.ids.push_back(root);
+        Site site{nullptr, engine, root};
+        roots.sites.push_back(sites_.insert(site, bounds(site)));
+    }
+}
+
+void OrbitSimulation::align(OrbitEngine *engine){
+    // orbits added to an engine of another clock start where they were added
+    if(engine->time() != time_){
+        engine->rebase(time_);
+    }
+}
+
+void OrbitSimulation::remove(OrbitalSystem *system){
+    auto found = systemIndex_.find(system);
+    if(found == systemIndex_.end()){
+        return;
+    }
+    std::size_t i = found->second;
+    systemIndex_.erase(found);
+    sites_.remove(systemSites_[i]);
+    if(i + 1 != systems_.size()){
+        systems_[i] = systems_.back();
+        systemSites_[i] = systemSites_.back();
+        systemIndex_[systems_[i]] = i;
+    }
+    systems_.pop_back();
+    systemSites_.pop_back();
+}
+
+void OrbitSimulation::remove(OrbitEngine *engine){
+    auto found = rootIndex_.find(engine);
+    if(found == rootIndex_.end()){
+        return;
+    }
+    std::size_t i = found->second;
+    rootIndex_.erase(found);
+    for(Sites::Handle site : roots_[i].sites){
+        sites_.remove(site);
+    }
+    if(i + 1 != roots_.size()){
+        std::swap(roots_[i], roots_.back());
+        rootIndex_[roots_[i].engine] = i;
+    }
+    roots_.pop_back();
+}
+
+void OrbitSimulation::remove(OrbitEngine *engine, OrbitEngine::Id root){
+    auto found = rootIndex_.find(engine);
+    if(found == rootIndex_.end()){
+        return;
+    }
+    Roots &roots = roots_[found->second];
+    auto id = roots.index.find(root);
+    if(id == roots.index.end()){
+        return;
+    }
+    std::size_t i = id->second;
+    roots.index.erase(id);
+    sites_.remove(roots.sites[i]);
+    if(i + 1 != roots.ids.size()){
+        roots.ids[i] = roots.ids.back();
+        roots.sites[i] = roots.sites.back();
+        roots.index[roots.ids[i]] = i;
+    }
+    roots.ids.pop_back();
+    roots.sites.pop_back();
+    // the engine stays registered so its clock keeps up
+}
+
+void OrbitSimulation::clear(){
+    systems_.clear();
+    systemSites_.clear();
+    sites_.clear();
+    systemIndex_.clear();
+    roots_.clear();
+    rootIndex_.clear();
+}
+
+template<typename Visitor>
+void OrbitSimulation::visit(Visitor visitor) const{
+    for(OrbitalSystem *system : systems_){
+        if(OrbitEngine *engine = this->engine(system)){
+            visitor(engine, system->orbitId());
+        }
+    }
+    for(const Roots &roots : roots_){
+        for(OrbitEngine::Id root : roots.ids){
+            visitor(roots.engine, root);
+        }
+    }
+}
+
+OrbitSimulation::Batch &OrbitSimulation::batch(OrbitEngine *engine){
+    auto found = batchIndex_.emplace(engine, batches_.size());
+    if(found.second){
+        batches_.push_back(Batch{engine, {}, false});
+    }
+    return batches_[found.first->second];
+}
+
+void OrbitSimulation::view(const ViewPoint &view){
+    view_ = view;
+    hasView_ = true;
+}
+
+OrbitDetail OrbitSimulation::detail(OrbitalSystem *system){
+    OrbitEngine *engine = this->engine(system);
+    return engine ? detail(engine, system->orbitId()) : OrbitDetail::FULL;
+}
+
+OrbitDetail OrbitSimulation::detail(OrbitEngine *engine, OrbitEngine::Id root){
+    if(!hasView_){
+        return OrbitDetail::FULL;
+    }
+    return classify(view_, engine->position(root), engine->extent(root));
+}
+
+void OrbitSimulation::schedule(OrbitEngine *engine, OrbitEngine::Id root, std::size_t number, std::size_t tick){
+    OrbitDetail detail = this->detail(engine, root);
+    // every engine visited gets a batch, so its clock advances with no root due
+    Batch &batch = this->batch(engine);
+    if(detail == OrbitDetail::FULL || (detail == OrbitDetail::REDUCED && (tick + number) % REDUCED_INTERVAL == 0)){
+        batch.roots.push_back(root);
+    }
+}
+
+void OrbitSimulation::update(){
+    time_ += 1.;
+    const std::size_t tick = static_cast<std::size_t>(time_);
+    batches_.clear();
+    batchIndex_.clear();
+    // engines of roots are few and shared, their clocks always advance
+    for(const Roots &roots : roots_){
+        batch(roots.engine);
+    }
+    if(!hasView_){
+        visit([this, tick](OrbitEngine *engine, OrbitEngine::Id root){
+            schedule(engine, root, 0, tick);
+        });
+    }else{
+        // everything farther from the view than the margin is ON_DEMAND
+        const Scalar half = 1. / view_.zoom;
+        const Scalar reach = half + 2. * half * NEAR_MARGIN;
+        const Position center{-view_.position.x * half, -view_.position.y * half};
+        sites_.query(Core::Bounds<Scalar>{center.x - reach, center.x + reach, center.y - reach, center.y + reach}, [this, tick](Sites::Handle handle){
+            OrbitEngine::Id root;
+            if(OrbitEngine *engine = this->engine(sites_[handle], root)){
+                // handles are stable, unlike the order the tree yields them in
+                schedule(engine, root, handle, tick);
+            }
+        });
+    }
+    run(time_);
+}
+
+void OrbitSimulation::evaluate(Scalar time){
+    time_ = time;
+    batches_.clear();
+    batchIndex_.clear();
+    visit([this](OrbitEngine *engine, OrbitEngine::Id){
+        batch(engine).all = true;
+    });
+    for(const Roots &roots : roots_){
+        batch(roots.engine).all = true;
+    }
+    run(time_);
+    for(Sites::Handle site : systemSites_){
+        sites_.update(site, bounds(sites_[site]));
+    }
+    for(const Roots &roots : roots_){
+        for(Sites::Handle site : roots.sites){
+            sites_.update(site, bounds(sites_[site]));
+        }
+    }
+}
+
+void OrbitSimulation::refresh(OrbitalSystem *system){
+    if(OrbitEngine *engine = this->engine(system)){
+        refresh(engine, system->orbitId());
+    }
+}
+
+void OrbitSimulation::refresh(OrbitEngine *engine, OrbitEngine::Id root){
+    if(engine->time(root) != time_){
+        batches_.clear();
+        batchIndex_.clear();
+        batch(engine).roots.push_back(root);
+        run(time_);
+    }
+}
+
+void OrbitSimulation::run(Scalar time){
+    pool_.parallel(batches_.size(), [this, time](std::size_t i){
+        Batch &batch = batches_[i];
+        if(batch.all){
+            batch.engine->prepare(time, grain_);
+        }else{
+            batch.engine->prepare(time, batch.roots, grain_);
+        }
+    });
+    jobs_.clear();
+    for(const Batch &batch : batches_){
+        for(const OrbitEngine::Job &range : batch.engine->jobs()){
+            jobs_.push_back(Job{batch.engine, range});
+        }
+    }
+    pool_.parallel(jobs_.size(), [this](std::size_t i){
+        jobs_[i].engine->evaluate(jobs_[i].range);
+    });
+    for(const Batch &batch : batches_){
+        // engines not tracked yet are copied in full by the next capture
+        if(Tracked *tracked = this->tracked(batch.engine)){
+            batch.engine->evaluated(tracked->evaluated);
+        }
+    }
+}
+
+OrbitSimulation::Tracked *OrbitSimulation::tracked(const OrbitEngine *engine){
+    auto found = std::lower_bound(tracked_.begin(), tracked_.end(), engine, [](const Tracked &tracked, const OrbitEngine *engine){
+        return tracked.engine < engine;
+    });
+    return found != tracked_.end() && found->engine == engine ? &*found : nullptr;
+}
+
+Scalar OrbitSimulation::time() const{
+    return time_;
+}
+
+Position OrbitSimulation::position(const Body &body) const{
+    OrbitEngine *engine = body.engine();
+    return engine ? position(engine, body.orbitId()) : body.position();
+}
+
+Position OrbitSimulation::position(const OrbitEngine *engine, OrbitEngine::Id id) const{
+    return engine->time(id) == time_ ? engine->position(id) : engine->position(id, time_);
+}
+
+void OrbitSimulation::capture(OrbitPositions &positions){
+    track();
+    copy(positions);
+}
+
+void OrbitSimulation::track(){
+    captureEngines_.clear();
+    // systems mostly share few engines, runs of one are gathered once
+    for(OrbitalSystem *system : systems_){
+        OrbitEngine *engine = this->engine(system);
+        if(engine && (captureEngines_.empty() || captureEngines_.back() != engine)){
+            captureEngines_.push_back(engine);
+        }
+    }
+    for(const Roots &roots : roots_){
+        captureEngines_.push_back(roots.engine);
+    }
+    std::sort(captureEngines_.begin(), captureEngines_.end());
+    captureEngines_.erase(std::unique(captureEngines_.begin(), captureEngines_.end()), captureEngines_.end());
+    bool same = captureEngines_.size() == tracked_.size();
+    for(std::size_t i = 0; same && i < tracked_.size(); ++i){
+        same = tracked_[i].engine == captureEngines_[i];
+    }
+    if(!same){
+        std::vector<Tracked> tracked;
+        std::vector<CapturedOrbits> captured;
+        tracked.reserve(captureEngines_.size());
+        captured.reserve(captureEngines_.size());
+        for(OrbitEngine *engine : captureEngines_){
+            Tracked *old = this->tracked(engine);
+            if(old){
+                tracked.push_back(std::move(*old));
+                captured.push_back(std::move(captured_.engines[old - tracked_.data()]));
+            }else{
+                tracked.push_back(Tracked{engine, 0, {}});
+                captured.push_back(CapturedOrbits{});
+                captured.back().engine = engine;
+            }
+        }
+        tracked_.swap(tracked);
+        captured_.engines.swap(captured);
+    }
+
+    ++captured_.sequence;
+    captured_.time = time_;
+    Changes &changes = history_[captured_.sequence % HISTORY];
+    changes.sequence = captured_.sequence;
+    changes.orbits.clear();
+    for(std::size_t i = 0; i < tracked_.size(); ++i){
+        Tracked &tracked = tracked_[i];
+        CapturedOrbits &orbits = captured_.engines[i];
+        const OrbitEngine *engine = tracked.engine;
+        if(orbits.generation == 0 || tracked.layout != engine->layout()){
+            engine->positions(orbits.positions);
+            orbits.previous = orbits.positions;
+            engine->roots(orbits.roots, orbits.times);
+            orbits.previousTimes.assign(orbits.times.size(), -std::numeric_limits<Scalar>::infinity());
+            orbits.generation = ++generation_;
+            tracked.layout = engine->layout();
+        }else{
+            for(OrbitEngine::Id id : tracked.evaluated){
+                orbits.previous[id] = orbits.positions[id];
+                orbits.positions[id] = engine->position(id);
+                if(orbits.roots[id] == id){
+                    orbits.previousTimes[id] = orbits.times[id];
+                    orbits.times[id] = engine->time(id);
+                }
+                changes.orbits.push_back(std::make_pair(engine, id));
+            }
+        }
+        tracked.evaluated.clear();
+    }
+}
+
+void OrbitSimulation::copy(OrbitPositions &positions){
+    if(positions.sequence == 0 || positions.sequence > captured_.sequence || positions.sequence + HISTORY < captured_.sequence){
+        positions = captured_;
+        return;
+    }
+    bool same = positions.engines.size() == captured_.engines.size();
+    for(std::size_t i = 0; same && i < captured_.engines.size(); ++i){
+        same = positions.engines[i].engine == captured_.engines[i].engine;
+    }
+    if(!same){
+        std::vector<CapturedOrbits> engines(captured_.engines.size());
+        for(std::size_t i = 0; i < engines.size(); ++i){
+            const OrbitEngine *engine = captured_.engines[i].engine;
+            auto found = std::lower_bound(positions.engines.begin(), positions.engines.end(), engine, [](const CapturedOrbits &orbits, const OrbitEngine *engine){
+                return orbits.engine < engine;
+            });
+            if(found != positions.engines.end() && found->engine == engine){
+                engines[i] = std::move(*found);
+            }
+        }
+        positions.engines.swap(engines);
+    }
+    // engines copied in full need none of the changes
+    copied_.assign(captured_.engines.size(), 0);
+    for(std::size_t i = 0; i < captured_.engines.size(); ++i){
+        if(positions.engines[i].generation != captured_.engines[i].generation){
+            positions.engines[i] = captured_.engines[i];
+            copied_[i] = 1;
+        }
+    }
+    const CapturedOrbits *from = nullptr;
+    CapturedOrbits *to = nullptr;
+    const OrbitEngine *engine = nullptr;
+    for(std::uint64_t sequence = positions.sequence + 1; sequence <= captured_.sequence; ++sequence){
+        for(const auto &orbit : history_[sequence % HISTORY].orbits){
+            if(orbit.first != engine){
+                engine = orbit.first;
+                from = captured_.find(engine);
+                // engines no longer simulated or copied in full are skipped
+                std::size_t i = from ? static_cast<std::size_t>(from - captured_.engines.data()) : 0;
+                to = from && !copied_[i] ? &positions.engines[i] : nullptr;
+            }
+            if(!to){
+                continue;
+            }
+            const OrbitEngine::Id id = orbit.second;
+            to->positions[id] = from->positions[id];
+            to->previous[id] = from->previous[id];
+            if(from->roots[id] == id){
+                to->times[id] = from->times[id];
+                to->previousTimes[id] = from->previousTimes[id];
+            }
+        }
+    }
+    positions.time = captured_.time;
+    positions.sequence = captured_.sequence;
+}
@@ -0,0 +1,329 @@
+/*
+ * File:   OrbitSimulation.h
+ * Author: hans
+ *
+ * Created on October 20, 2026, 9:15 AM
+ */
+
+#ifndef ORBITSIMULATION_H
+#define	ORBITSIMULATION_H
+
+#include "Orbit.h"
+#include "ThreadPool.h"
+#include "LooseQuadtree.h"
+
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <cstdint>
+
+namespace Game{
+
+    /*
+     * Captured orbits of one engine, all indexed by id
+     */
+    struct CapturedOrbits{
+        const OrbitEngine *engine;
+        // changes whenever the arrays are copied in full
+        std::uint64_t generation;
+        std::vector<Position> positions;
+        // positions before their last evaluation
+        std::vector<Position> previous;
+        std::vector<OrbitEngine::Id> roots;
+        // the last two times each root was evaluated at
+        std::vector<Scalar> times;
+        std::vector<Scalar> previousTimes;
+
+        CapturedOrbits();
+    };
+
+    /*
+     * Positions of all orbits of a set of engines at one tick, each with the
+     * times its root was last evaluated at. A capture is brought up to date
+     * in place, copying only the orbits evaluated since it was last, so
+     * reused captures cost no allocations.
+     */
+    struct OrbitPositions{
+        // simulation time of the capture
+        Scalar time;
+        std::uint64_t sequence;
+        // sorted by engine
+        std::vector<CapturedOrbits> engines;
+
+        OrbitPositions();
+
+        /*
+         * Null if the engine was not captured
+         */
+        const CapturedOrbits *find(const OrbitEngine *engine) const;
+
+        /*
+         * Null if the engine or id was not captured
+         */
+        const Position *find(const OrbitEngine *engine, OrbitEngine::Id id) const;
+    };
+
+    /*
+     * Positions of the bodies as shown by one frame: the given fraction of
+     * the way from the tick before the capture to the capture, or the
+     * bodies' own positions without one
+     */
+    class OrbitFrame{
+    public:
+        OrbitFrame(const OrbitPositions *positions = nullptr, Scalar fraction = 1.);
+
+        Position position(const Body &body) const;
+
+        Position position(const OrbitEngine *engine, OrbitEngine::Id id) const;
+
+    private:
+        const OrbitPositions *positions_;
+        Scalar fraction_;
+    };
+
+    /*
+     * How often a system's orbits are updated
+     */
+    enum class OrbitDetail{
+        // every tick
+        FULL,
+        // every REDUCED_INTERVAL ticks
+        REDUCED,
+        // only when refreshed or queried
+        ON_DEMAND
+    };
+
+    /*
+     * Advances the orbits of many independent systems together on a pool.
+     * A system is either an orbital system or a root of an engine, which
+     * may hold any number of them. The systems due are split into jobs of
+     * whole subtrees, so a single large system is spread over the workers
+     * as well. Every job writes its
+     * own range of positions and the split does not depend on the pool, the
+     * results are the same for any number of threads.
+     *
+     * With a view set, ticks only update the systems worth it: systems in
+     * view every tick, systems close to the view or too small to make out in
+     * the strategic view at a reduced rate, all others not at all. Orbits are
+     * a function of time, so skipped systems are exact again as soon as they
+     * are evaluated or queried.
+     *
+     * The systems near the view are looked up in a quadtree of the areas
+     * their orbits stay within, as of when they were added or last
+     * evaluated; systems far from it are not visited at all, which leaves
+     * the clocks of their engines behind until the next evaluate().
+     */
+    class OrbitSimulation{
+    public:
+
+        static const unsigned REDUCED_INTERVAL;
+
+        static const std::uint64_t HISTORY;
+
+        OrbitSimulation(Core::ThreadPool &pool, std::size_t grain = OrbitEngine::DEFAULT_GRAIN);
+
+        /*
+         * Only root systems are simulated, attached systems are part of their
+         * root's engine
+         */
+        void add(OrbitalSystem *system);
+
+        /*
+         * Simulates a root of an engine of no orbital system and its
+         * subtree, its distance to the view measured from the root
+         */
+        void add(OrbitEngine *engine, OrbitEngine::Id root);
+
+        void remove(OrbitalSystem *system);
+
+        /*
+         * Removes all roots of the engine
+         */
+        void remove(OrbitEngine *engine);
+
+        void remove(OrbitEngine *engine, OrbitEngine::Id root);
+
+        void clear();
+
+        /*
+         * Schedules the following ticks for this view
+         */
+        void view(const ViewPoint &view);
+
+        /*
+         * Advances the time by one tick and updates the systems due; attach
+         * orbits only after evaluate(), the engines of systems out of view
+         * are not advanced
+         */
+        void update();
+
+        /*
+         * Updates all systems to the given time and places them in the
+         * quadtree again
+         */
+        void evaluate(Scalar time);
+
+        /*
+         * Updates one system to the current time; like position(), only on
+         * the thread running the simulation, see SimulationThread::refresh()
+         */
+        void refresh(OrbitalSystem *system);
+
+        void refresh(OrbitEngine *engine, OrbitEngine::Id root);
+
+        Scalar time() const;
+
+        /*
+         * Exact position of a simulated body at the current time, whether or
+         * not its system was updated
+         */
+        Position position(const Body &body) const;
+
+        Position position(const OrbitEngine *engine, OrbitEngine::Id id) const;
+
+        OrbitDetail detail(OrbitalSystem *system);
+
+        OrbitDetail detail(OrbitEngine *engine, OrbitEngine::Id root);
+
+        /*
+         * Captures the current tick into positions, copying only the orbits
+         * evaluated since positions was last captured into. Only the last
+         * HISTORY captures are tracked, older ones are copied in full.
+         */
+        void capture(OrbitPositions &positions);
+
+    private:
+
+        /*
+         * Simulated system in the quadtree, either an orbital system or a
+         * root of an engine
+         */
+        struct Site{
+            OrbitalSystem *system;
+            OrbitEngine *engine;
+            OrbitEngine::Id root;
+        };
+
+        using Sites = Core::LooseQuadtree<Site, Scalar>;
+
+        /*
+         * Roots added for one engine
+         */
+        struct Roots{
+            OrbitEngine *engine;
+            std::vector<OrbitEngine::Id> ids;
+            std::unordered_map<OrbitEngine::Id, std::size_t> index;
+            // parallel to ids
+            std::vector<Sites::Handle> sites;
+        };
+
+        /*
+         * Roots of one engine updated together, or all of them
+         */
+        struct Batch{
+            OrbitEngine *engine;
+            std::vector<OrbitEngine::Id> roots;
+            bool all;
+        };
+
+        struct Job{
+            OrbitEngine *engine;
+            OrbitEngine::Job range;
+        };
+
+        /*
+         * Engine captured last, with the orbits evaluated since
+         */
+        struct Tracked{
+            OrbitEngine *engine;
+            std::uint64_t layout;
+            std::vector<OrbitEngine::Id> evaluated;
+        };
+
+        /*
+         * Orbits changed by one capture
+         */
+        struct Changes{
+            std::uint64_t sequence;
+            std::vector<std::pair<const OrbitEngine *, OrbitEngine::Id> > orbits;
+        };
+
+        Core::ThreadPool &pool_;
+        std::size_t grain_;
+        std::vector<OrbitalSystem *> systems_;
+        // parallel to systems_
+        std::vector<Sites::Handle> systemSites_;
+        std::unordered_map<OrbitalSystem *, std::size_t> systemIndex_;
+        std::vector<Roots> roots_;
+        std::unordered_map<OrbitEngine *, std::size_t> rootIndex_;
+        std::vector<Batch> batches_;
+        std::unordered_map<OrbitEngine *, std::size_t> batchIndex_;
+        std::vector<Job> jobs_;
+        Sites sites_;
+        // parallel to captured_.engines
+        std::vector<Tracked> tracked_;
+        OrbitPositions captured_;
+        std::vector<Changes> history_;
+        std::vector<OrbitEngine *> captureEngines_;
+        std::vector<char> copied_;
+        std::uint64_t generation_;
+        ViewPoint view_;
+        bool hasView_;
+        Scalar time_;
+
+        /*
+         * Engine of a root system, null for attached or empty systems
+         */
+        static OrbitEngine *engine(OrbitalSystem *system);
+
+        /*
+         * Engine and root of a site, null for attached or empty systems
+         */
+        static OrbitEngine *engine(const Site &site, OrbitEngine::Id &root);
+
+        /*
+         * Area the orbits of a site never leave
+         */
+        static Core::Bounds<Scalar> bounds(const Site &site);
+
+        /*
+         * Adds the systems due this tick to the batch of their engine,
+         * spreading the ones at the reduced rate by their number
+         */
+        void schedule(OrbitEngine *engine, OrbitEngine::Id root, std::size_t number, std::size_t tick);
+
+        /*
+         * Calls visitor with the engine and root of every system
+         */
+        template<typename Visitor>
+        void visit(Visitor visitor) const;
+
+        /*
+         * Batch of the engine for the running update, added if missing
+         */
+        Batch &batch(OrbitEngine *engine);
+
+        void align(OrbitEngine *engine);
+
+        void run(Scalar time);
+
+        Tracked *tracked(const OrbitEngine *engine);
+
+        /*
+         * Brings the captured copy of the engines up to date
+         */
+        void track();
+
+        /*
+         * Brings positions up to the captured copy
+         */
+        void copy(OrbitPositions &positions);
+
+        OrbitSimulation(const OrbitSimulation &) = delete;
+        OrbitSimulation &operator=(const OrbitSimulation &) = delete;
+    };
+
+}
+
+#endif	/* ORBITSIMULATION_H */
+
@@ -0,0 +1,44 @@
+#include "PackFile.h"
+#include "Path.h"
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdio>
+
+using Core::Path;
+
+int main(int argCount, const char **args) {
+    if (argCount < 3) {
+        std::cout << "usage: " << args[0] << " <module folder> <pack file> [--store]" << std::endl;
+        return 1;
+    }
+    Path folder{args[1]};
+    Path pack{args[2]};
+    bool compress = !(argCount > 3 && std::string{args[3]} == "--store");
+    if (!folder.folderExists()) {
+        std::cout << "module folder '" << folder << "' not found" << std::endl;
+        return 1;
+    }
+    Path temporary{pack.data() + ".tmp"};
+    try {
+        std::ofstream output{temporary.data().c_str(), std::ios::binary};
+        Core::PackFile::write(folder, output, compress);
+        output.close();
+        if (std::rename(temporary.data().c_str(), pack.data().c_str()) != 0) {
+            throw Core::PackException{"unable to move pack file into place"};
+        }
+    } catch (std::exception &e) {
+        std::remove(temporary.data().c_str());
+        std::cout << "unable to pack module folder '" << folder << "': " << e.what() << std::endl;
+        return 1;
+    }
+    Core::PackFile result;
+    if (result.open(pack)) {
+        std::cout << "packed " << result.size() << " files from '" << folder << "' into '" << pack << "'" << std::endl;
+        return 0;
+    } else {
+        std::cout << "written pack file '" << pack << "' can not be opened" << std::endl;
+        return 1;
+    }
+}
@@ -1,7 +1,314 @@
 #include "ResourceIndexer.h"
 
 #include "Parser.h"
+#include "String.h"
+#include "JSONWriter.h"
+#include "DirectorySnapshot.h"
+#include "VirtualFileSystem.h"
+
+#include <algorithm>
+#include <fstream>
+#include <cstdio>
 
 using namespace Game;
+using Core::Path;
+
+namespace {
+
+    const char *TYPE_NAMES[] = {"module", "pack", "star", "planet", "bundle", "script"};
+
+    const std::size_t TYPE_COUNT = sizeof (TYPE_NAMES) / sizeof (TYPE_NAMES[0]);
+
+    const std::string PACK_EXTENSION{".pack"};
+
+    const std::string SCRIPT_EXTENSION{".py"};
+
+    bool endsWith(const std::string &name, const std::string &extension){
+        return name.length() > extension.length() && name.compare(name.length() - extension.length(), extension.length(), extension) == 0;
+    }
+
+    ResourceType typeFromName(const std::string &name){
+        for(std::size_t i = 0; i < TYPE_COUNT; ++i){
+            if(name == TYPE_NAMES[i]){
+                return static_cast<ResourceType>(i);
+            }
+        }
+        throw ResourceIndexException{Core::toString("unknown resource type '", name, "'")};
+    }
+
+    /*
+     * Resources are folders, their descriptor tells when they changed
+     */
+    Core::FileStatus entryStatus(ResourceType type, const Path &path){
+        return (type == ResourceType::STAR || type == ResourceType::PLANET) ? path.child("descriptor").status() : path.status();
+    }
+
+}
 
 ResourceIndexException::ResourceIndexException(std::string message) : std::runtime_error(message){};
+
+ResourceIndexEntry::ResourceIndexEntry() : id(), type(ResourceType::MODULE), module(), path(), size(), modified(), modifiedNanoseconds(){}
+
+const int ResourceIndexer::VERSION = 2;
+
+ResourceIndexer::ResourceIndexer() : modulesPath_(), entries_(), containers_(){}
+
+void ResourceIndexer::clear(){
+    modulesPath_.clear();
+    entries_.clear();
+    containers_.clear();
+}
+
+bool ResourceIndexer::open(Path modulesPath, Path indexPath){
+    if(load(modulesPath, indexPath)){
+        return true;
+    }
+    build(modulesPath);
+    try{
+        write(indexPath);
+    }catch(ResourceIndexException &e){
+        std::cout << "unable to store resource index: " << e.what() << std::endl;
+    }
+    return false;
+}
+
+void ResourceIndexer::addContainer(Path path){
+    Core::FileStatus status{path.status()};
+    containers_.push_back(Container{path.data(), status.exists, status.modified, status.modifiedNanoseconds});
+}
+
+void ResourceIndexer::add(ResourceType type, std::string id, Path module, Path path){
+    ResourceIndexEntry entry;
+    entry.id = id;
+    entry.type = type;
+    entry.module = module;
+    entry.path = path;
+    Core::FileStatus status{entryStatus(type, path)};
+    entry.size = status.size;
+    entry.modified = status.modified;
+    entry.modifiedNanoseconds = status.modifiedNanoseconds;
+    entries_.push_back(entry);
+}
+
+void ResourceIndexer::indexFolders(ResourceType type, Path module, Path folder){
+    addContainer(folder);
+    for(auto child : folder.childFolders()){
+        add(type, child.name(), module, child);
+    }
+}
+
+void ResourceIndexer::indexModule(Path module){
+    addContainer(module);
+    Path resources{module.child("resource")};
+    addContainer(resources);
+    indexFolders(ResourceType::STAR, module, resources.child("star"));
+    indexFolders(ResourceType::PLANET, module, resources.child("planet"));
+    Path languageLabels{module.child("language_labels")};
+    if(languageLabels.fileExists()){
+        add(ResourceType::BUNDLE, languageLabels.name(), module, languageLabels);
+    }
+    for(auto child : resources.children()){
+        Core::FileStatus status{child.status()};
+        if(status.exists && !status.folder){
+            add(ResourceType::BUNDLE, child.name(), module, child);
+        }
+    }
+    Path maps{module.child("maps")};
+    addContainer(maps);
+    for(auto child : maps.children()){
+        std::string name{child.name()};
+        if(endsWith(name, SCRIPT_EXTENSION)){
+            add(ResourceType::SCRIPT, name.substr(0, name.length() - SCRIPT_EXTENSION.length()), module, child);
+        }
+    }
+}
+
+void ResourceIndexer::build(Path modulesPath){
+    clear();
+    modulesPath_ = modulesPath.data();
+    Core::DirectorySnapshot::global().scan(modulesPath, 0);
+    addContainer(modulesPath);
+    std::list<Path> children{modulesPath.children()};
+    std::set<std::string> folders;
+    for(auto child : children){
+        // ask the snapshot so folders mounted from packs are not taken for loose modules
+        Core::FileStatus status;
+        if(Core::DirectorySnapshot::global().status(child.data(), status) ? status.folder : child.status().folder){
+            folders.insert(child.name());
+        }
+    }
+    for(auto child : children){
+        if(folders.count(child.name())){
+            add(ResourceType::MODULE, child.name(), child, child);
+            indexModule(child);
+        }
+    }
+    for(auto child : children){
+        std::string name{child.name()};
+        if(endsWith(name, PACK_EXTENSION)){
+            std::string moduleId{name.substr(0, name.length() - PACK_EXTENSION.length())};
+            if(folders.count(moduleId)){
+                std::cout << "module folder '" << moduleId << "' takes precedence over pack '" << child << "'" << std::endl;
+            }else{
+                add(ResourceType::PACK, moduleId, modulesPath.child(moduleId), child);
+            }
+        }
+    }
+    mountPacks();
+    // indexing the mounted modules appends to entries_
+    const std::size_t count = entries_.size();
+    for(std::size_t i = 0; i < count; ++i){
+        ResourceIndexEntry entry{entries_[i]};
+        if(entry.type == ResourceType::PACK && entry.module.folderExists()){
+            add(ResourceType::MODULE, entry.id, entry.module, entry.module);
+            indexModule(entry.module);
+        }
+    }
+}
+
+void ResourceIndexer::mountPacks() const{
+    for(const ResourceIndexEntry &entry : entries_){
+        if(entry.type == ResourceType::PACK && !Core::VirtualFileSystem::global().mount(entry.module, entry.path)){
+            std::cout << "unable to mount module pack '" << entry.path << "'" << std::endl;
+        }
+    }
+}
+
+bool ResourceIndexer::valid() const{
+    for(const Container &container : containers_){
+        Core::FileStatus status{Path{container.path}.status()};
+        if(status.exists != container.exists || (status.exists && (status.modified != container.modified || status.modifiedNanoseconds != container.modifiedNanoseconds))){
+            return false;
+        }
+    }
+    for(const ResourceIndexEntry &entry : entries_){
+        // a module folder is also a container
+        if(entry.type == ResourceType::MODULE){
+            continue;
+        }
+        Core::FileStatus status{entryStatus(entry.type, entry.path)};
+        // folders have no meaningful size, their containers cover them
+        if(!status.exists || status.modified != entry.modified || status.modifiedNanoseconds != entry.modifiedNanoseconds || (!status.folder && status.size != entry.size)){
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ResourceIndexer::load(Path modulesPath, Path indexPath){
+    clear();
+    if(!indexPath.fileExists()){
+        return false;
+    }
+    try{
+        std::ifstream input;
+        indexPath.openFile(input);
+        IO::Document document{IO::open(input)};
+        IO::Object root{document.rootNode().object()};
+        if(static_cast<int>(root.getNumber("version")) != VERSION || root.getString("modulesPath") != modulesPath.data()){
+            return false;
+        }
+        modulesPath_ = modulesPath.data();
+        IO::Array containers{root.getArray("containers")};
+        for(auto i = containers.begin(); i != containers.end(); ++i){
+            IO::Object container{(*i).object()};
+            containers_.push_back(Container{container.getString("path"), container.getBoolean("exists"), static_cast<std::int64_t>(container.getNumber("modified")), static_cast<std::int64_t>(container.getNumber("modifiedNanoseconds"))});
+        }
+        IO::Array entries{root.getArray("entries")};
+        for(auto i = entries.begin(); i != entries.end(); ++i){
+            IO::Object data{(*i).object()};
+            ResourceIndexEntry entry;
+            entry.id = data.getString("id");
+            entry.type = typeFromName(data.getString("type"));
+            entry.module = Path{data.getString("module")};
+            entry.path = Path{data.getString("path")};
+            entry.size = static_cast<std::uint64_t>(data.getNumber("size"));
+            entry.modified = static_cast<std::int64_t>(data.getNumber("modified"));
+            entry.modifiedNanoseconds = static_cast<std::int64_t>(data.getNumber("modifiedNanoseconds"));
+            entries_.push_back(entry);
+        }
+    }catch(std::exception &e){
+        std::cout << "unable to read resource index '" << indexPath << "': " << e.what() << std::endl;
+        clear();
+        return false;
+    }
+    // containers inside packs are only visible once the packs are mounted
+    mountPacks();
+    if(!valid()){
+        for(const ResourceIndexEntry &entry : entries_){
+            if(entry.type == ResourceType::PACK){
+                Core::VirtualFileSystem::global().unmount(entry.module);
+            }
+        }
+        clear();
+        return false;
+    }
+    return true;
+}
+
+void ResourceIndexer::write(Path indexPath) const{
+    Path temporary{indexPath.data()+".tmp"};
+    std::ofstream output;
+    if(!temporary.openFile(output)){
+        throw ResourceIndexException{Core::toString("unable to open index file '", temporary, "'")};
+    }
+    output.precision(17);
+    JSON::MinifiedWriter<> writer{output};
+    writer.beginObject();
+    writer.beginField("version").writeNumber(VERSION).endField();
+    writer.beginField("modulesPath").writeString(modulesPath_).endField();
+    writer.beginField("containers").beginArray();
+    for(const Container &container : containers_){
+        writer.beginObject();
+        writer.beginField("path").writeString(container.path).endField();
+        writer.beginField("exists").writeBoolean(container.exists).endField();
+        writer.beginField("modified").writeNumber(static_cast<double>(container.modified)).endField();
+        writer.beginField("modifiedNanoseconds").writeNumber(static_cast<double>(container.modifiedNanoseconds)).endField();
+        writer.endObject();
+    }
+    writer.endArray().endField();
+    writer.beginField("entries").beginArray();
+    for(const ResourceIndexEntry &entry : entries_){
+        writer.beginObject();
+        writer.beginField("id").writeString(entry.id).endField();
+        writer.beginField("type").writeString(TYPE_NAMES[static_cast<std::size_t>(entry.type)]).endField();
+        writer.beginField("module").writeString(entry.module.data()).endField();
+        writer.beginField("path").writeString(entry.path.data()).endField();
+        writer.beginField("size").writeNumber(static_cast<double>(entry.size)).endField();
+        writer.beginField("modified").writeNumber(static_cast<double>(entry.modified)).endField();
+        writer.beginField("modifiedNanoseconds").writeNumber(static_cast<double>(entry.modifiedNanoseconds)).endField();
+        writer.endObject();
+    }
+    writer.endArray().endField();
+    writer.endObject();
+    output.close();
+    if(!output.good() || std::rename(temporary.data().c_str(), indexPath.data().c_str()) != 0){
+        std::remove(temporary.data().c_str());
+        throw ResourceIndexException{Core::toString("unable to write index file '", indexPath, "'")};
+    }
+}
+
+std::list<Path> ResourceIndexer::paths(ResourceType type) const{
+    std::list<Path> result;
+    for(const ResourceIndexEntry &entry : entries_){
+        if(entry.type == type){
+            result.push_back(entry.path);
+        }
+    }
+    return result;
+}
+
+std::list<Path> ResourceIndexer::paths(ResourceType type, Path module) const{
+    std::list<Path> result;
+    for(const ResourceIndexEntry &entry : entries_){
+        if(entry.type == type && entry.module.data() == module.data()){
+            result.push_back(entry.path);
+        }
+    }
+    return result;
+}
+
+const std::vector<ResourceIndexEntry> &ResourceIndexer::entries() const{
+    return entries_;
+}
+
@@ -1,4 +1,4 @@
-/* 
+/*
  * File:   ResourceIndexer.h
  * Author: hans
  *
@@ -12,6 +12,10 @@
 
 #include <unordered_map>
 #include <set>
+#include <vector>
+#include <list>
+#include <string>
+#include <cstdint>
 #include <stdexcept>
 
 namespace Game{
@@ -20,8 +24,85 @@ namespace Game{
     public:
         ResourceIndexException(std::string message);
     };
-    
-    
+
+    enum class ResourceType{
+        MODULE, PACK, STAR, PLANET, BUNDLE, SCRIPT
+    };
+
+    struct ResourceIndexEntry{
+        std::string id;
+        ResourceType type;
+        Core::Path module;
+        Core::Path path;
+        std::uint64_t size;
+        std::int64_t modified;
+        std::int64_t modifiedNanoseconds;
+
+        ResourceIndexEntry();
+    };
+
+    /*
+     * Every module and resource below the modules folder, stored in a file so
+     * later starts stat what was indexed instead of walking the whole tree:
+     * the folders that change when resources are added or removed, and each
+     * resource's file or descriptor to catch edits in place, one stat per
+     * container and resource. Modules are covered by their folder.
+     * Module packs without a loose folder are mounted as part of opening.
+     */
+    class ResourceIndexer{
+    public:
+        static const int VERSION;
+
+        ResourceIndexer();
+
+        /*
+         * Uses the stored index if it is still valid, rebuilds and stores it
+         * otherwise; returns true if the stored index was used
+         */
+        bool open(Core::Path modulesPath, Core::Path indexPath);
+
+        void build(Core::Path modulesPath);
+
+        bool load(Core::Path modulesPath, Core::Path indexPath);
+
+        void write(Core::Path indexPath) const;
+
+        std::list<Core::Path> paths(ResourceType type) const;
+
+        std::list<Core::Path> paths(ResourceType type, Core::Path module) const;
+
+        const std::vector<ResourceIndexEntry> &entries() const;
+
+    private:
+
+        struct Container{
+            std::string path;
+            bool exists;
+            std::int64_t modified;
+            std::int64_t modifiedNanoseconds;
+        };
+
+        std::string modulesPath_;
+        std::vector<ResourceIndexEntry> entries_;
+        std::vector<Container> containers_;
+
+        void clear();
+
+        void addContainer(Core::Path path);
+
+        void add(ResourceType type, std::string id, Core::Path module, Core::Path path);
+
+        void indexModule(Core::Path module);
+
+        void indexFolders(ResourceType type, Core::Path module, Core::Path folder);
+
+        void mountPacks() const;
+
+        bool valid() const;
+
+        ResourceIndexer(const ResourceIndexer &) = delete;
+        ResourceIndexer &operator=(const ResourceIndexer &) = delete;
+    };
 
 }
 
@@ -1,6 +1,7 @@
 #include "Script.h"
 
 #include "String.h"
+#include "VirtualFileSystem.h"
 
 using namespace Script;
 using namespace Core;
@@ -25,7 +26,7 @@ int ScriptExecutionException::column() const {
 }
 
 std::string ScriptSystem::getCodeFromFile(Core::Path path){
-    std::ifstream buffer;
+    Core::FileInput buffer;
     path.openFile(buffer);
     if(buffer.good()){
         std::streampos pos = buffer.tellg();
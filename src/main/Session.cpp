@@ -9,6 +9,7 @@
 #include "Settings.h"
 
 #include "Module.h"
+#include "Data.h"
 
 using namespace Game;
 
@@ -18,13 +19,15 @@ const Scalar Session::MIN_ZOOM_LEVEL{0.00001};
 
 const Scalar Session::MAX_ZOOM_LEVEL{0.1};
 
+const unsigned Session::TICKS_PER_SECOND{30};
+
 Session::ScrollRegion::ScrollRegion() : scrolling(), bounds(), vector(){}
 
 void Session::ScrollRegion::check(int x, int y){
     scrolling = bounds.contains(x,y);
 }
 
-Session::Session() : viewPoint_(Position{}, 0.1, ViewMode::STRATEGIC), window_(), settings_(), running_(false), scrollRegions(), starResources_(), planetResources_(), starSystem_() {}
+Session::Session() : viewPoint_(Position{}, 0.1, ViewMode::STRATEGIC), window_(), settings_(), running_(false), scrollRegions(), workers_(), textures_(workers_, TexelCache::global().folder()), simulation_(workers_), simulationThread_(simulation_, TICKS_PER_SECOND), starResources_(textures_), planetResources_(textures_), bodies_(), starSystem_(BodyStore::NONE), index_(bodies_), visible_() {}
 
 void Session::startEventLoop() {
     using clock = std::chrono::high_resolution_clock;
@@ -42,7 +45,12 @@ void Session::startEventLoop() {
     glEnable(GL_TEXTURE_2D);
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     
+    std::size_t textureBudget = static_cast<std::size_t>(settings_.videoSettings.textureMemory) * 1024 * 1024;
+    starResources_.cache().budget(textureBudget / 2);
+    planetResources_.cache().budget(textureBudget / 2);
+    textures_.prune();
     loadTestScenario();
+    simulationThread_.start();
     
     WindowEvent event;
     running_.store(true);
@@ -51,9 +59,14 @@ void Session::startEventLoop() {
     time lastFrame = clock::now();
     while (running_.load()) {
         handleEvents();
-        starSystem_->updateOrbits();
+        simulationThread_.view(viewPoint_);
+        textures_.upload();
         draw();
         window_.render();
+        starResources_.reclaim();
+        planetResources_.reclaim();
+        starResources_.cache().nextFrame();
+        planetResources_.cache().nextFrame();
         time afterRender = clock::now();
         duration elapsed = afterRender - lastFrame;
         if (elapsed < waitBetweenFrames) {
@@ -65,6 +78,7 @@ void Session::startEventLoop() {
         }
     }
     
+    simulationThread_.stop();
     glDisable(GL_TEXTURE_2D);
     unloadTestScenario();
 }
@@ -73,10 +87,34 @@ void Session::draw() {
     glClearColor(0.f, 0.f, 0.f, 1.f);
     glClear(GL_COLOR_BUFFER_BIT);
     glMatrixMode(GL_MODELVIEW);
-    starSystem_->draw();
+    OrbitFrame frame = simulationThread_.frame();
+    Core::Bounds<Scalar> bounds = viewPoint_.bounds();
+    index_.update(frame, bounds);
+    index_.query(bounds, visible_);
+    for(const GalaxyIndex::Entry &entry : visible_){
+        if(entry.body == BodyStore::NONE){
+            continue;
+        }else if(bodies_.kind(entry.body) == BodyStore::Kind::STAR){
+            Star{bodies_, entry.body}.draw(viewPoint_.mode, frame);
+        }else{
+            Planet{bodies_, entry.body}.draw(viewPoint_.mode, frame);
+        }
+    }
     viewPoint_.loadProjectionMatrix();
 }
 
+void Session::pick(Position point, std::vector<GalaxyIndex::Entry> &entries){
+    Core::Bounds<Scalar> bounds{point.x, point.x, point.y, point.y};
+    index_.query(bounds, entries);
+    for(const GalaxyIndex::Entry &entry : entries){
+        if(entry.body == BodyStore::NONE){
+            simulationThread_.refresh(&bodies_.engine(), bodies_.orbit(entry.system));
+        }
+    }
+    index_.update(simulationThread_.frame(), bounds);
+    index_.pick(point, entries);
+}
+
 void Session::handleEvents() {
     int mouseWheelDelta = 0;
     sf::Event event;
@@ -137,29 +175,26 @@ void Session::zoom(int delta) {
 }
 
 void Session::loadTestScenario() {
+    const ResourceIndexer &index = ApplicationSystem<ModuleLoader>::instance().index();
     const Module *module = ApplicationSystem<ModuleLoader>::instance().activeModule();
     const std::list<Path> &paths = module->paths();
     std::cout << "loading resources for module " << module->id() << std::endl;
     std::cout << "loading star resources" << std::endl;
+    std::list<Path> starFolders;
+    std::list<Path> planetFolders;
     for(auto path : paths){
-        std::list<Path> folders = path.child("resource").child("star").childFolders();
-        for(auto folder : folders){
-            try{
-                starResources_.load(folder);
-            }catch(Core::ResourceException &e){
-                std::cout << "unable to load resources from folder " << folder << " : " << e.what() << "... skipping" << std::endl;
-            }
-        }
-        folders = path.child("resource").child("planet").childFolders();
-        for(auto folder : folders){
-            try{
-                planetResources_.load(folder);
-            }catch(Core::ResourceException &e){
-                std::cout << "unable to load resources from folder " << folder << " : " << e.what() << "... skipping" << std::endl;
-            }
-        }
+        starFolders.splice(starFolders.end(), index.paths(ResourceType::STAR, path));
+        planetFolders.splice(planetFolders.end(), index.paths(ResourceType::PLANET, path));
     }
-    starSystem_ = new StarSystem();
+    std::list<std::string> errors;
+    starResources_.load(starFolders, workers_, errors);
+    planetResources_.load(planetFolders, workers_, errors);
+    for(auto error : errors){
+        std::cout << "unable to load resources: " << error << "... skipping" << std::endl;
+    }
+    starSystem_ = bodies_.addSystem(U"", Position{});
+    simulation_.add(&bodies_.engine(), bodies_.orbit(starSystem_));
+    index_.build();
     //starSystem_->star = new Star{starSystem_, U"Alpha Centauri A",Position{0,0},2000.,starResources_["main_sequence_yellow_01"]};
     //starSystem_->add(new Planet{starSystem_, U"1 Alpha Centauri A", 50., planetResources_["gas_giant_01"]}, 3200., (2*pi()) / 6000., 3*pi()/4);
     //Planet *planet = new Planet{starSystem_, U"2 Alpha Centauri A ", 200., planetResources_["gas_giant_01"]};
@@ -171,7 +206,10 @@ void Session::loadTestScenario() {
 }
 
 void Session::unloadTestScenario(){
-    delete starSystem_;
+    simulation_.clear();
+    index_.clear();
+    bodies_.clear();
+    starSystem_ = BodyStore::NONE;
 }
 
 const PlanetResourceLoader &Session::planetResourceLoader() const {
@@ -182,4 +220,10 @@ const StarResourceLoader &Session::starResourceLoader() const{
     return starResources_;
 }
 
+const GalaxyIndex &Session::galaxyIndex() const{
+    return index_;
+}
 
+Core::ThreadPool &Session::workers(){
+    return workers_;
+}
@@ -13,6 +13,9 @@
 #include "Settings.h"
 
 #include "Star.h"
+#include "OrbitSimulation.h"
+#include "SimulationThread.h"
+#include "GalaxyIndex.h"
 
 #include <atomic>
 
@@ -25,6 +28,8 @@ namespace Game{
     
         static const Scalar MAX_ZOOM_LEVEL;
         
+        static const unsigned TICKS_PER_SECOND;
+        
         Session();
 
         void startEventLoop();
@@ -35,6 +40,17 @@ namespace Game{
         
         const PlanetResourceLoader &planetResourceLoader() const;
         
+        const GalaxyIndex &galaxyIndex() const;
+
+        /*
+         * Bodies covering point, the closest center first. Systems the view
+         * leaves behind are picked where they were last simulated and
+         * refreshed for the following frames.
+         */
+        void pick(Position point, std::vector<GalaxyIndex::Entry> &entries);
+        
+        Core::ThreadPool &workers();
+        
     private:
 
         struct ScrollRegion{
@@ -65,10 +81,18 @@ namespace Game{
         std::atomic<bool> running_;
         ScrollRegion scrollRegions[8];
         
+        Core::ThreadPool workers_;
+        TextureLoader textures_;
+        OrbitSimulation simulation_;
+        SimulationThread simulationThread_;
+        
         StarResourceLoader starResources_;
         PlanetResourceLoader planetResources_;
         
-        StarSystem *starSystem_;
+        BodyStore bodies_;
+        BodyStore::Id starSystem_;
+        GalaxyIndex index_;
+        std::vector<GalaxyIndex::Entry> visible_;
     };
     
 }
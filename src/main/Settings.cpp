@@ -18,7 +18,7 @@ using Writer = JSON::PrettyWriter<>;
 SettingsException::SettingsException(std::string message) : std::runtime_error(message){
 }
 
-VideoSettings::VideoSettings() : antialiasingLevel(4),framesPerSecond(60) {
+VideoSettings::VideoSettings() : antialiasingLevel(4),framesPerSecond(60),textureMemory(512) {
 }
 
 ControlSettings::ControlSettings() : zoomSpeed(1.0), mouseScrollSpeed(0.01), keyScrollSpeed(0.01){}
@@ -37,6 +37,9 @@ void validateVideoSettings(const VideoSettings &settings){
     if(settings.framesPerSecond < 10 || settings.framesPerSecond > 100){
         throw SettingsException("frames per second should be set in the range of 10 - 100");
     }
+    if(settings.textureMemory < 16){
+        throw SettingsException("texture memory should be set to at least 16 MB");
+    }
 }
 
 void validateWindowSettings(const WindowSettings &settings){
@@ -51,12 +54,16 @@ void validateWindowSettings(const WindowSettings &settings){
 void readVideoSettings(Object node, VideoSettings &settings){
     settings.antialiasingLevel=static_cast<int>(node.getNumber("antialisingLevel"));
     settings.framesPerSecond = static_cast<int>(node.getNumber("framesPerSecond"));
+    if(node.hasNumber("textureMemory")){
+        settings.textureMemory = static_cast<int>(node.getNumber("textureMemory"));
+    }
 };
 
 void writeVideoSettings(Writer &writer, const VideoSettings &settings){
     writer.beginObject();
     writer.beginField("antialisingLevel").writeNumber(settings.antialiasingLevel).endField();
     writer.beginField("framesPerSecond").writeNumber(settings.framesPerSecond).endField();
+    writer.beginField("textureMemory").writeNumber(settings.textureMemory).endField();
     writer.endObject();
 };
 
@@ -20,6 +20,7 @@ namespace Game{
     struct VideoSettings{
         int antialiasingLevel;
         int framesPerSecond;
+        int textureMemory;
         
         VideoSettings();
     };
@@ -0,0 +1,103 @@
+#include "SimulationThread.h"
+
+#include <algorithm>
+#include <utility>
+
+using namespace Game;
+
+SimulationThread::Snapshot::Snapshot() : published(), positions(){
+}
+
+SimulationThread::SimulationThread(OrbitSimulation &simulation, unsigned ticksPerSecond)
+: simulation_(simulation), tick_(std::chrono::duration_cast<Clock::duration>(std::chrono::seconds{1}) / std::max(1U, ticksPerSecond)), thread_(), running_(false), snapshots_(), viewMutex_(), view_(Position{}, 1., ViewMode::TACTICAL), viewChanged_(false), refreshes_(), pending_(){
+}
+
+SimulationThread::~SimulationThread(){
+    stop();
+}
+
+void SimulationThread::start(){
+    if(running_.load()){
+        return;
+    }
+    // the first snapshot is there before the first frame asks for it, the
+    // hierarchies may have changed since the last captures
+    simulation_.evaluate(simulation_.time());
+    // requests left from the last run are covered by the evaluation
+    refreshes_.clear();
+    Clock::time_point now = Clock::now();
+    publish(now);
+    running_.store(true);
+    thread_ = std::thread{&SimulationThread::run, this, now + tick_};
+}
+
+void SimulationThread::stop(){
+    running_.store(false);
+    if(thread_.joinable()){
+        thread_.join();
+        // the engines of systems out of view fell behind, bodies attached to
+        // them while stopped are placed at the current time
+        simulation_.evaluate(simulation_.time());
+    }
+}
+
+bool SimulationThread::running() const{
+    return running_.load();
+}
+
+void SimulationThread::publish(Clock::time_point time){
+    Snapshot &snapshot = snapshots_.back();
+    snapshot.published = time;
+    // the slot is brought up to date in place, keeping its memory
+    simulation_.capture(snapshot.positions);
+    snapshots_.publish();
+}
+
+void SimulationThread::run(Clock::time_point next){
+    while(running_.load()){
+        std::this_thread::sleep_until(next);
+        {
+            std::lock_guard<std::mutex> lock{viewMutex_};
+            if(viewChanged_){
+                simulation_.view(view_);
+                viewChanged_ = false;
+            }
+            std::swap(pending_, refreshes_);
+        }
+        simulation_.update();
+        // after the update, so the refreshed roots are at the published time
+        for(auto &root : pending_){
+            simulation_.refresh(root.first, root.second);
+        }
+        pending_.clear();
+        publish(next);
+        next += tick_;
+        Clock::time_point now = Clock::now();
+        if(now > next + 4 * tick_){
+            // too slow to catch up, let the simulation fall behind the clock
+            next = now;
+        }
+    }
+}
+
+void SimulationThread::view(const ViewPoint &view){
+    std::lock_guard<std::mutex> lock{viewMutex_};
+    view_ = view;
+    viewChanged_ = true;
+}
+
+void SimulationThread::refresh(OrbitEngine *engine, OrbitEngine::Id root){
+    std::lock_guard<std::mutex> lock{viewMutex_};
+    if(running_.load()){
+        refreshes_.push_back(std::make_pair(engine, root));
+    }else{
+        simulation_.refresh(engine, root);
+    }
+}
+
+OrbitFrame SimulationThread::frame(){
+    snapshots_.acquire();
+    const Snapshot &snapshot = snapshots_.front();
+    Scalar fraction = std::chrono::duration<Scalar>(Clock::now() - snapshot.published) / std::chrono::duration<Scalar>(tick_);
+    return OrbitFrame{&snapshot.positions, std::min(std::max(fraction, 0.), 1.)};
+}
@@ -0,0 +1,95 @@
+/*
+ * File:   SimulationThread.h
+ * Author: hans
+ *
+ * Created on October 20, 2026, 11:45 AM
+ */
+
+#ifndef SIMULATIONTHREAD_H
+#define	SIMULATIONTHREAD_H
+
+#include "OrbitSimulation.h"
+#include "TripleBuffer.h"
+
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+namespace Game{
+
+    /*
+     * Runs an orbit simulation at a fixed tick rate on its own thread, so the
+     * simulated time only depends on the wall clock, not on the frame rate.
+     * After every tick the positions are published to the render thread,
+     * which shows them a fraction of a tick late, interpolated between the
+     * last two ticks.
+     *
+     * While running, the simulated hierarchies may only be read through
+     * frame() and refreshed through refresh(); attach or detach bodies after
+     * stop().
+     */
+    class SimulationThread{
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        SimulationThread(OrbitSimulation &simulation, unsigned ticksPerSecond);
+
+        ~SimulationThread();
+
+        void start();
+
+        void stop();
+
+        bool running() const;
+
+        /*
+         * View the following ticks are scheduled for, see OrbitSimulation
+         */
+        void view(const ViewPoint &view);
+
+        /*
+         * Brings a root the view leaves behind up to date with the next
+         * tick, right away while stopped
+         */
+        void refresh(OrbitEngine *engine, OrbitEngine::Id root);
+
+        /*
+         * Positions for a frame drawn now, valid until the next call; only
+         * called from the render thread
+         */
+        OrbitFrame frame();
+
+    private:
+
+        struct Snapshot{
+            Clock::time_point published;
+            OrbitPositions positions;
+
+            Snapshot();
+        };
+
+        OrbitSimulation &simulation_;
+        Clock::duration tick_;
+        std::thread thread_;
+        std::atomic<bool> running_;
+        Core::TripleBuffer<Snapshot> snapshots_;
+        std::mutex viewMutex_;
+        ViewPoint view_;
+        bool viewChanged_;
+        std::vector<std::pair<OrbitEngine *, OrbitEngine::Id> > refreshes_;
+        std::vector<std::pair<OrbitEngine *, OrbitEngine::Id> > pending_;
+
+        void publish(Clock::time_point time);
+
+        void run(Clock::time_point next);
+
+        SimulationThread(const SimulationThread &) = delete;
+        SimulationThread &operator=(const SimulationThread &) = delete;
+    };
+
+}
+
+#endif	/* SIMULATIONTHREAD_H */
+
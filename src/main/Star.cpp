@@ -3,6 +3,12 @@
 #include "Star.h"
 #include "String.h"
 #include "IO.h"
+#include "VirtualFileSystem.h"
+#include "BulkFileLoader.h"
+
+#include <vector>
+#include <memory>
+#include <utility>
 
 using namespace Game;
 
@@ -10,107 +16,232 @@ using Core::Path;
 
 OrbitalBodyResource::OrbitalBodyResource(std::string id_) : id(id_), strategicTexture(), tacticalTexture(){};
 
+const Texture &OrbitalBodyResource::texture(ViewMode mode) const{
+    return mode == ViewMode::STRATEGIC ? strategicTexture : tacticalTexture;
+}
+
+OrbitalBodyResourceLoader::OrbitalBodyResourceLoader(TextureLoader &textures) : Core::ConcurrentResourceBundle<std::string, OrbitalBodyResource>(), cache_(), textures_(textures){
+}
+
+Core::ResourceCache &OrbitalBodyResourceLoader::cache(){
+    return cache_;
+}
+
+OrbitalBodyResourceLoader::Descriptor OrbitalBodyResourceLoader::readDescriptor(Core::Path descriptor, std::istream &input){
+    try{
+        IO::Document document{IO::open(input)};
+        IO::Object object = document.rootNode().object();
+        Descriptor result;
+        result.id = object.getString("id");
+        result.strategic = object.getString("strategic");
+        result.tactical = object.getString("tactical");
+        return result;
+    }catch(std::exception &e){
+        throw Core::ResourceException{Core::toString("loading star resource from path '", descriptor, "' descriptor parsing error: ", e.what())};
+    }
+}
+
+OrbitalBodyResource *OrbitalBodyResourceLoader::create(Core::Path path, const Descriptor &descriptor){
+    Path strategic{path.child(descriptor.strategic)};
+    if(!strategic.fileExists()){
+        throw Core::ResourceException{Core::toString("loading star resource '", descriptor.id, "' strategic image not found at path ", strategic)};
+    }
+    Path tactical{path.child(descriptor.tactical)};
+    if(!tactical.fileExists()){
+        throw Core::ResourceException{Core::toString("loading star resource '", descriptor.id, "' tactical image not found at path ", tactical)};
+    }
+    OrbitalBodyResource *resource = new OrbitalBodyResource(descriptor.id);
+    for(Texture *texture : {&resource->strategicTexture, &resource->tacticalTexture}){
+        texture->attach(&cache_);
+        texture->attach(&textures_);
+    }
+    resource->strategicTexture.assign(strategic);
+    resource->tacticalTexture.assign(tactical);
+    return resource;
+}
+
 void OrbitalBodyResourceLoader::load(Core::Path path){
     Path descriptor{path.child("descriptor")};
     if(descriptor.fileExists()){
-        std::ifstream input;
+        Core::FileInput input;
         descriptor.openFile(input);
-        IO::Document document{IO::open(input)};
-        IO::Object object = document.rootNode().object();
-        try{
-            std::string id = object.getString("id");
-            std::string strategic = object.getString("strategic");
-            std::string tactical = object.getString("tactical");
-            OrbitalBodyResource *resource = new OrbitalBodyResource(id);
-            std::string file{path.child(strategic).data()};
-            if(resource->strategicTexture.load(file)){
-                file = path.child(tactical).data();
-                if(resource->tacticalTexture.load(file)){
-                    Core::ResourceBundle<std::string, OrbitalBodyResource>::add(id, resource);
-                }else{
-                    delete resource;
-                    throw Core::ResourceException{Core::toString("loading star resource '", id, "' unable to load tactical image from path ", file)};
+        Descriptor read{readDescriptor(descriptor, input)};
+        std::unique_ptr<OrbitalBodyResource> resource{create(path, read)};
+        Core::ConcurrentResourceBundle<std::string, OrbitalBodyResource>::add(read.id, resource.get());
+        resource.release();
+    }
+}
+
+void OrbitalBodyResourceLoader::load(const std::list<Core::Path> &paths, Core::ThreadPool &pool, std::list<std::string> &errors){
+    std::vector<Descriptor> descriptors(paths.size());
+    std::vector<std::string> failures(paths.size());
+    Core::BulkFileLoader loader{pool};
+    std::size_t index = 0;
+    for(auto path : paths){
+        Descriptor &descriptor = descriptors[index];
+        std::string &failure = failures[index];
+        loader.add(path.child("descriptor"), [&descriptor, &failure](const Path &descriptorPath, bool success, std::vector<char> &data){
+            if(success){
+                Core::MemoryBuffer buffer;
+                buffer.assign(data.data(), data.size());
+                std::istream input{&buffer};
+                try{
+                    descriptor = readDescriptor(descriptorPath, input);
+                }catch(Core::ResourceException &e){
+                    failure = e.what();
                 }
-            }else{
-                delete resource;
-                throw Core::ResourceException{Core::toString("loading star resource '", id, "' unable to load strategic image from path ", file)};
             }
-        }catch(std::exception &e){
-            throw Core::ResourceException{Core::toString("loading star resource from path '", descriptor, "' descriptor parsing error: ", e.what())};
+        });
+        ++index;
+    }
+    loader.run();
+    // published together, every add copies the table
+    std::vector<std::pair<std::string, const OrbitalBodyResource *> > created;
+    created.reserve(paths.size());
+    index = 0;
+    try{
+        for(auto path : paths){
+            if(!failures[index].empty()){
+                errors.push_back(failures[index]);
+            }else if(!descriptors[index].id.empty()){
+                try{
+                    created.push_back(std::make_pair(descriptors[index].id, create(path, descriptors[index])));
+                }catch(Core::ResourceException &e){
+                    errors.push_back(e.what());
+                }
+            }
+            ++index;
+        }
+        Core::ConcurrentResourceBundle<std::string, OrbitalBodyResource>::add(created.begin(), created.end());
+    }catch(...){
+        for(auto &entry : created){
+            delete entry.second;
         }
+        throw;
+    }
+}
+
+namespace {
+
+    void drawBody(Position position, Scalar radius, const OrbitalBodyResource *resource, ViewMode mode){
+        glLoadIdentity();
+        resource->texture(mode).bind();
+        glBegin(GL_QUADS);
+        glTexCoord2d(0,0);
+        glVertex3d(position.x - radius, position.y - radius, 0);
+        glTexCoord2d(1.0,0);
+        glVertex3d(position.x + radius, position.y - radius, 0);
+        glTexCoord2d(1.0,1.0);
+        glVertex3d(position.x + radius, position.y + radius, 0);
+        glTexCoord2d(0,1.0);
+        glVertex3d(position.x - radius, position.y + radius, 0);
+        glEnd();
     }
 
 }
 
-Star::Star(StarSystem *system_, std::u32string name_, Scalar radius_, const StarResource* resource_) 
-: OrbitalSystem(), system(system_), name(name_), radius(radius_), resource(resource_){}
+Star::Star(const BodyStore &store, BodyStore::Id id) : store_(&store), id_(id){}
 
-void Star::draw(){
-    glLoadIdentity();
-    glBindTexture(GL_TEXTURE_2D, resource->tacticalTexture.id);
-    glBegin(GL_QUADS);
-    glTexCoord2d(0,0);
-    glVertex3d(position.x-radius, position.y-radius, 0);
-    glTexCoord2d(1.0,0);
-    glVertex3d(position.x+radius, position.y-radius, 0);
-    glTexCoord2d(1.0,1.0);
-    glVertex3d(position.x+radius, position.y+radius, 0);
-    glTexCoord2d(0,1.0);
-    glVertex3d(position.x-radius, position.y+radius, 0);
-    glEnd();
+BodyStore::Id Star::id() const{
+    return id_;
 }
 
-Planet::Planet(StarSystem *system_, std::u32string name_, Scalar radius_, const PlanetResource* resource_) 
-: OrbitalSystem(), system(system_), name(name_), radius(radius_), resource(resource_), moons(){}
+StarSystem Star::system() const{
+    return StarSystem{*store_, store_->system(id_)};
+}
 
-Planet::~Planet(){
-    for(auto moon : moons){
-        delete moon;
-    }
+const std::u32string &Star::name() const{
+    return store_->name(id_);
 }
 
-void Planet::draw(){
-    glLoadIdentity();
-    glBindTexture(GL_TEXTURE_2D, resource->tacticalTexture.id);
-    glBegin(GL_QUADS);
-    glTexCoord2d(0,0);
-    glVertex3d(position.x - radius, position.y - radius, 0);
-    glTexCoord2d(1.0,0);
-    glVertex3d(position.x+radius, position.y - radius, 0);
-    glTexCoord2d(1.0,1.0);
-    glVertex3d(position.x+radius, position.y+radius, 0);
-    glTexCoord2d(0,1.0);
-    glVertex3d(position.x - radius, position.y+radius, 0);
-    glEnd();
-    for(auto moon : moons){
-        moon->draw();
-    }
+Scalar Star::radius() const{
+    return store_->radius(id_);
 }
 
-StarSystem::StarSystem() : name(), stars(), planets(){}
+const StarResource *Star::resource() const{
+    return store_->resource(id_);
+}
 
-StarSystem::StarSystem(std::u32string name, Position position_) : name(name), stars(), planets(){
-    position = position_;
+Position Star::position() const{
+    return store_->position(id_);
 }
 
-StarSystem::~StarSystem(){
-    for(auto star : stars){
-        delete star;
-    }
-    for(auto planet : planets){
-        delete planet;
-    }
+void Star::draw(ViewMode mode, const OrbitFrame &frame) const{
+    drawBody(frame.position(&store_->engine(), store_->orbit(id_)), radius(), resource(), mode);
+}
+
+Planet::Planet(const BodyStore &store, BodyStore::Id id) : store_(&store), id_(id){}
+
+BodyStore::Id Planet::id() const{
+    return id_;
+}
+
+StarSystem Planet::system() const{
+    return StarSystem{*store_, store_->system(id_)};
+}
+
+const std::u32string &Planet::name() const{
+    return store_->name(id_);
+}
+
+Scalar Planet::radius() const{
+    return store_->radius(id_);
+}
+
+const PlanetResource *Planet::resource() const{
+    return store_->resource(id_);
 }
 
-void StarSystem::updateOrbits() {
-    orbitUpdated();
+Position Planet::position() const{
+    return store_->position(id_);
 }
 
-void StarSystem::draw() {
-    for(auto star : stars){
-        star->draw();
+std::vector<Planet> Planet::moons() const{
+    std::vector<Planet> moons;
+    BodyStore::Id body = store_->firstChild(id_);
+    while(body != BodyStore::NONE){
+        BodyStore::Kind kind = store_->kind(body);
+        if(kind == BodyStore::Kind::PLANET){
+            moons.push_back(Planet{*store_, body});
+        }else if(kind == BodyStore::Kind::BARYCENTER && store_->firstChild(body) != BodyStore::NONE){
+            // moons orbiting each other hang below their barycenter
+            body = store_->firstChild(body);
+            continue;
+        }
+        while(body != id_ && store_->nextSibling(body) == BodyStore::NONE){
+            body = store_->parent(body);
+        }
+        body = body == id_ ? BodyStore::NONE : store_->nextSibling(body);
     }
-    for(auto planet : planets){
-        planet->draw();
+    return moons;
+}
+
+void Planet::draw(ViewMode mode, const OrbitFrame &frame) const{
+    drawBody(frame.position(&store_->engine(), store_->orbit(id_)), radius(), resource(), mode);
+}
+
+StarSystem::StarSystem(const BodyStore &store, BodyStore::Id id) : store_(&store), id_(id){}
+
+BodyStore::Id StarSystem::id() const{
+    return id_;
+}
+
+const std::u32string &StarSystem::name() const{
+    return store_->name(id_);
+}
+
+Position StarSystem::position() const{
+    return store_->position(id_);
+}
+
+OrbitEngine &StarSystem::engine() const{
+    return store_->engine();
+}
+
+void StarSystem::draw(ViewMode mode, const OrbitFrame &frame) const{
+    for(BodyStore::Id body = store_->firstChild(id_); body != BodyStore::NONE; body = store_->next(body, id_)){
+        if(store_->kind(body) != BodyStore::Kind::BARYCENTER){
+            drawBody(frame.position(&engine(), store_->orbit(body)), store_->radius(body), store_->resource(body), mode);
+        }
     }
 }
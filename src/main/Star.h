@@ -9,13 +9,20 @@
 #define	STAR_H
 
 #include <string>
+#include <list>
+#include <vector>
+#include <istream>
 
 #include "Feature.h"
 #include "Metrics.h"
 #include "Path.h"
-#include "Resource.h"
+#include "ConcurrentResource.h"
+#include "ThreadPool.h"
 #include "Texture.h"
 #include "Orbit.h"
+#include "BodyStore.h"
+#include "OrbitSimulation.h"
+#include "Graphics.h"
 
 namespace Game{
     
@@ -30,15 +37,49 @@ namespace Game{
         
         OrbitalBodyResource(std::string id);
         
+        const Texture &texture(ViewMode mode) const;
+        
     private:
         OrbitalBodyResource(const OrbitalBodyResource &) = delete;
         OrbitalBodyResource &operator=(const OrbitalBodyResource &) = delete;
     };
         
-    class OrbitalBodyResourceLoader : public Core::ResourceBundle<std::string, OrbitalBodyResource>{
+    class OrbitalBodyResourceLoader : public Core::ConcurrentResourceBundle<std::string, OrbitalBodyResource>{
     public:
         
+        /*
+         * Textures are only read from their files once they are drawn,
+         * decoding is done by the given loader
+         */
+        OrbitalBodyResourceLoader(TextureLoader &textures);
+        
         void load(Core::Path path);
+        
+        /*
+         * Reads all descriptors in one batch on the pool, then creates the
+         * resources on the calling thread; failures are reported in errors
+         */
+        void load(const std::list<Core::Path> &paths, Core::ThreadPool &pool, std::list<std::string> &errors);
+        
+        Core::ResourceCache &cache();
+        
+    private:
+        
+        struct Descriptor{
+            std::string id;
+            std::string strategic;
+            std::string tactical;
+        };
+        
+        Core::ResourceCache cache_;
+        TextureLoader &textures_;
+        
+        static Descriptor readDescriptor(Core::Path descriptor, std::istream &input);
+        
+        /*
+         * New resource for the descriptor, not yet added
+         */
+        OrbitalBodyResource *create(Core::Path path, const Descriptor &descriptor);
                 
     };
     
@@ -48,65 +89,94 @@ namespace Game{
 
     using StarResourceLoader = OrbitalBodyResourceLoader;    
     
-    class Star : public OrbitalSystem{
+    /*
+     * Accessor for a star in a body store
+     */
+    class Star{
     public:
-        StarSystem *system;
-        std::u32string name;
-        Scalar radius;        
-        const StarResource *resource;
+        Star(const BodyStore &store, BodyStore::Id id);
+        
+        BodyStore::Id id() const;
         
-        Star(StarSystem *system, std::u32string name, Scalar radius, const StarResource *resource);
+        StarSystem system() const;
         
-        void draw();
+        const std::u32string &name() const;
         
-        void update();
+        Scalar radius() const;
+        
+        const StarResource *resource() const;
+        
+        Position position() const;
+        
+        void draw(ViewMode mode, const OrbitFrame &frame) const;
         
     private:
-        Star(const Star &) = delete;
-        Star &operator=(const Star &) = delete;
+        const BodyStore *store_;
+        BodyStore::Id id_;
     };
     
     using PlanetResource = OrbitalBodyResource;
 
     using PlanetResourceLoader = OrbitalBodyResourceLoader;      
     
-    class Planet : public OrbitalSystem{
+    /*
+     * Accessor for a planet or moon in a body store
+     */
+    class Planet{
     public:
-        StarSystem *system;
-        std::u32string name;
-        Scalar radius;        
-        const PlanetResource *resource;
-        std::list<Planet *> moons;
+        Planet(const BodyStore &store, BodyStore::Id id);
+        
+        BodyStore::Id id() const;
+        
+        StarSystem system() const;
         
-        Planet(StarSystem *system, std::u32string name, Scalar radius, const PlanetResource *resource);
+        const std::u32string &name() const;
         
-        ~Planet();
+        Scalar radius() const;
         
-        void draw();
+        const PlanetResource *resource() const;
+        
+        Position position() const;
+        
+        /*
+         * Planets orbiting this one directly or through barycenters, found
+         * by walking its children
+         */
+        std::vector<Planet> moons() const;
+        
+        /*
+         * Draws the planet without its moons
+         */
+        void draw(ViewMode mode, const OrbitFrame &frame) const;
         
     private:
-        Planet(const Planet &) = delete;
-        Planet &operator=(const Planet &) = delete;
+        const BodyStore *store_;
+        BodyStore::Id id_;
     };
     
-    class StarSystem : public OrbitalSystem{
-    public:    
-        std::u32string name;
-        std::list<Star *> stars;
-        std::list<Planet *> planets;
+    /*
+     * Accessor for a star system in a body store
+     */
+    class StarSystem{
+    public:
+        StarSystem(const BodyStore &store, BodyStore::Id id);
+        
+        BodyStore::Id id() const;
         
-        StarSystem();
+        const std::u32string &name() const;
         
-        StarSystem(std::u32string name, Position position);
+        Position position() const;
         
-        void draw();
+        OrbitEngine &engine() const;
         
-        void updateOrbits();
+        /*
+         * Draws all stars, planets and moons
+         */
+        void draw(ViewMode mode, const OrbitFrame &frame) const;
         
-        ~StarSystem();
     private:
-        StarSystem(const StarSystem &) = delete;
-        StarSystem &operator=(const StarSystem &) = delete;
+        const BodyStore *store_;
+        BodyStore::Id id_;
     };
     
 }
@@ -0,0 +1,196 @@
+#include "TexelCache.h"
+#include "VirtualFileSystem.h"
+#include "Hash.h"
+#include "Data.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <iterator>
+#include <thread>
+#include <functional>
+#include <cstring>
+#include <cstdio>
+
+using namespace Game;
+
+namespace {
+
+    const char MAGIC[4] = {'S', 'P', 'T', 'X'};
+
+    const std::string EXTENSION{".texels"};
+
+    std::string hex(std::uint64_t value){
+        std::ostringstream output;
+        output << std::hex << std::setw(16) << std::setfill('0') << value;
+        return output.str();
+    }
+
+}
+
+TexelImage::TexelImage() : file_(), data_(), offset_(), width_(), height_(){
+}
+
+unsigned TexelImage::width() const{
+    return width_;
+}
+
+unsigned TexelImage::height() const{
+    return height_;
+}
+
+const std::uint8_t *TexelImage::pixels() const{
+    return file_ ? reinterpret_cast<const std::uint8_t *>(file_->data()) + offset_ : data_.data();
+}
+
+bool TexelImage::empty() const{
+    return !width_ || !height_;
+}
+
+void TexelImage::assign(const sf::Image &image){
+    file_.reset();
+    offset_ = 0;
+    width_ = image.getSize().x;
+    height_ = image.getSize().y;
+    data_.assign(image.getPixelsPtr(), image.getPixelsPtr() + static_cast<std::size_t>(width_) * height_ * 4);
+}
+
+const std::uint32_t TexelCache::VERSION = 2;
+
+const TexelCache &TexelCache::global(){
+    static TexelCache cache{ApplicationSystem<DataSystem>::instance().runtimeDataPath().child("textures")};
+    return cache;
+}
+
+TexelCache::TexelCache(Core::Path folder) : folder_(folder){
+}
+
+const Core::Path &TexelCache::folder() const{
+    return folder_;
+}
+
+Core::Path TexelCache::entryPath(const Core::Path &file) const{
+    return folder_.child(hex(Core::hash(file.data()))+EXTENSION);
+}
+
+bool TexelCache::read(const Core::Path &file, std::vector<char> &data){
+    Core::FileInput input;
+    if(!file.openFile(input)){
+        return false;
+    }else if(input.inMemory()){
+        data.assign(input.data(), input.data() + input.size());
+    }else{
+        data.assign(std::istreambuf_iterator<char>{input}, std::istreambuf_iterator<char>{});
+    }
+    return true;
+}
+
+bool TexelCache::map(const Core::Path &entry, TexelImage &image, Header &header, std::string &source) const{
+    std::unique_ptr<Core::MappedFile> mapped{new Core::MappedFile{}};
+    if(!mapped->open(entry) || mapped->size() < sizeof (Header)){
+        return false;
+    }
+    std::memcpy(&header, mapped->data(), sizeof (Header));
+    const std::size_t pixels = static_cast<std::size_t>(header.width) * header.height * 4;
+    if(std::memcmp(header.magic, MAGIC, sizeof (MAGIC)) != 0 || header.version != VERSION
+            || header.sourceLength > mapped->size() || mapped->size() != sizeof (Header) + pixels + header.sourceLength){
+        return false;
+    }
+    const char *path = mapped->data() + sizeof (Header) + pixels;
+    source.assign(path, path + header.sourceLength);
+    image.data_.clear();
+    image.file_ = std::move(mapped);
+    image.offset_ = sizeof (Header);
+    image.width_ = header.width;
+    image.height_ = header.height;
+    return true;
+}
+
+bool TexelCache::find(const Core::Path &file, TexelImage &image) const{
+    Core::FileStatus status{file.status()};
+    Header header;
+    TexelImage found;
+    std::string source;
+    if(!status.exists || !map(entryPath(file), found, header, source) || source != file.data() || header.sourceSize != status.size){
+        return false;
+    }
+    if(header.sourceModified != status.modified || header.sourceModifiedNanoseconds != status.modifiedNanoseconds){
+        // touched or copied, still valid if the content is the same
+        std::vector<char> data;
+        if(!read(file, data) || Core::hash(data.data(), data.size()) != header.contentHash){
+            return false;
+        }
+    }
+    image = std::move(found);
+    return true;
+}
+
+bool TexelCache::store(const Core::Path &entry, const Header &header, const sf::Image &image, const std::string &source) const{
+    folder_.createFolder();
+    Core::Path temporary{entry.data()+"."+hex(std::hash<std::thread::id>{}(std::this_thread::get_id()))+".tmp"};
+    std::ofstream output;
+    if(!temporary.openFile(output)){
+        return false;
+    }
+    output.write(reinterpret_cast<const char *>(&header), sizeof (Header));
+    output.write(reinterpret_cast<const char *>(image.getPixelsPtr()), static_cast<std::streamsize>(header.width) * header.height * 4);
+    output.write(source.data(), static_cast<std::streamsize>(source.length()));
+    output.close();
+    if(!output.good() || std::rename(temporary.data().c_str(), entry.data().c_str()) != 0){
+        std::remove(temporary.data().c_str());
+        return false;
+    }
+    return true;
+}
+
+bool TexelCache::decode(const Core::Path &file, TexelImage &image) const{
+    Core::FileStatus status{file.status()};
+    std::vector<char> data;
+    sf::Image decoded;
+    if(!read(file, data) || !decoded.loadFromMemory(data.data(), data.size())){
+        return false;
+    }
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof (MAGIC));
+    header.version = VERSION;
+    header.width = decoded.getSize().x;
+    header.height = decoded.getSize().y;
+    header.sourceSize = status.size;
+    header.sourceModified = status.modified;
+    header.sourceModifiedNanoseconds = status.modifiedNanoseconds;
+    header.contentHash = Core::hash(data.data(), data.size());
+    header.sourceLength = file.data().length();
+    Core::Path entry{entryPath(file)};
+    std::string source;
+    if(!store(entry, header, decoded, file.data()) || !map(entry, image, header, source)){
+        image.assign(decoded);
+    }
+    return true;
+}
+
+bool TexelCache::load(const Core::Path &file, TexelImage &image) const{
+    return find(file, image) || decode(file, image);
+}
+
+std::size_t TexelCache::prune() const{
+    if(!folder_.folderExists()){
+        return 0;
+    }
+    std::size_t removed = 0;
+    for(const Core::Path &entry : folder_.children()){
+        std::string name{entry.data()};
+        if(name.length() < EXTENSION.length() || name.compare(name.length() - EXTENSION.length(), EXTENSION.length(), EXTENSION) != 0){
+            continue;
+        }
+        Header header;
+        TexelImage image;
+        std::string source;
+        if(!map(entry, image, header, source) || !Core::Path{source}.fileExists()){
+            // an entry a decode replaced meanwhile is only decoded again
+            if(std::remove(name.c_str()) == 0){
+                ++removed;
+            }
+        }
+    }
+    return removed;
+}
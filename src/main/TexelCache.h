@@ -0,0 +1,120 @@
+/*
+ * File:   TexelCache.h
+ * Author: hans
+ *
+ * Created on October 19, 2026, 9:05 PM
+ */
+
+#ifndef TEXELCACHE_H
+#define	TEXELCACHE_H
+
+#include "SFML/Graphics/Image.hpp"
+
+#include "Path.h"
+#include "MappedFile.h"
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+namespace Game{
+
+    /*
+     * Decoded RGBA pixels of an image, either mapped from a texel cache entry
+     * or owned
+     */
+    class TexelImage{
+    public:
+        TexelImage();
+
+        unsigned width() const;
+
+        unsigned height() const;
+
+        const std::uint8_t *pixels() const;
+
+        bool empty() const;
+
+        void assign(const sf::Image &image);
+
+    private:
+        std::unique_ptr<Core::MappedFile> file_;
+        std::vector<std::uint8_t> data_;
+        std::size_t offset_;
+        unsigned width_;
+        unsigned height_;
+
+        friend class TexelCache;
+    };
+
+    /*
+     * Decoded images of texture files stored in a folder below the runtime
+     * data path, keyed by the source path. An entry is used without reading
+     * the source if its size and modification time, to the nanosecond, are
+     * unchanged, and after comparing content hashes otherwise.
+     */
+    class TexelCache{
+    public:
+        static const std::uint32_t VERSION;
+
+        /*
+         * Cache in the runtime data path, used by textures without a loader
+         */
+        static const TexelCache &global();
+
+        TexelCache(Core::Path folder);
+
+        const Core::Path &folder() const;
+
+        /*
+         * Maps the stored image of file if it is still valid
+         */
+        bool find(const Core::Path &file, TexelImage &image) const;
+
+        /*
+         * Decodes file, stores the result and maps it; falls back to the
+         * decoded image if it can not be stored
+         */
+        bool decode(const Core::Path &file, TexelImage &image) const;
+
+        /*
+         * Maps the stored image of file or decodes it
+         */
+        bool load(const Core::Path &file, TexelImage &image) const;
+
+        /*
+         * Removes the entries of other versions and those whose source is
+         * gone; sources in mounted packs count only once they are mounted
+         */
+        std::size_t prune() const;
+
+        Core::Path entryPath(const Core::Path &file) const;
+
+    private:
+
+        struct Header{
+            char magic[4];
+            std::uint32_t version;
+            std::uint32_t width;
+            std::uint32_t height;
+            std::uint64_t sourceSize;
+            std::int64_t sourceModified;
+            std::int64_t sourceModifiedNanoseconds;
+            std::uint64_t contentHash;
+            // the source path follows the pixels
+            std::uint64_t sourceLength;
+        };
+
+        Core::Path folder_;
+
+        bool map(const Core::Path &entry, TexelImage &image, Header &header, std::string &source) const;
+
+        bool store(const Core::Path &entry, const Header &header, const sf::Image &image, const std::string &source) const;
+
+        static bool read(const Core::Path &file, std::vector<char> &data);
+    };
+
+}
+
+#endif	/* TEXELCACHE_H */
+
@@ -1,8 +1,10 @@
 #include "Texture.h"
 
+#include <iostream>
+
 using namespace Game;
 
-Texture::Texture() : id(0), image_(){
+Texture::Texture() : Core::CachedResource(), id(0), file_(), loader_(){
 }
 
 Texture::Texture(Core::Path file) : Texture(){
@@ -11,6 +13,9 @@ Texture::Texture(Core::Path file) : Texture(){
 
 Texture::~Texture() {
     unload();
+    if(loader_){
+        loader_->cancel(this);
+    }
 }
 
 Texture::operator bool() const{
@@ -22,31 +27,175 @@ bool Texture::operator !() const {
 }
 
 bool Texture::load(Core::Path file) {
+    assign(file);
+    TexelImage image;
+    return cache().load(file_, image) && upload(image.width(), image.height(), image.pixels());
+}
+
+void Texture::assign(Core::Path file) {
     unload();
-    std::string name{file.data()};
-    if(image_.loadFromFile(name)){
-        glGenTextures(1, &id);
-        if(id){
-            glBindTexture(GL_TEXTURE_2D, id);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image_.getSize().x, image_.getSize().y,0, GL_RGBA,GL_UNSIGNED_BYTE, image_.getPixelsPtr());
-            return true;
-        }
+    if(loader_){
+        loader_->cancel(this);
+    }
+    file_ = file;
+    failed(false);
+}
+
+const Core::Path &Texture::file() const{
+    return file_;
+}
+
+void Texture::attach(TextureLoader *loader){
+    if(loader_){
+        loader_->cancel(this);
+    }
+    loader_ = loader;
+}
+
+bool Texture::doLoad() {
+    if(loader_){
+        loader_->request(this);
+        return false;
+    }
+    TexelImage image;
+    if(cache().load(file_, image) && upload(image.width(), image.height(), image.pixels())){
+        return true;
     }
+    failed(true);
     return false;
 }
 
-bool Texture::unload() {
+const TexelCache &Texture::cache() const{
+    return loader_ ? loader_->cache() : TexelCache::global();
+}
+
+bool Texture::upload(unsigned width, unsigned height, const void *pixels) {
+    doUnload();
+    glGenTextures(1, &id);
+    if(id){
+        glBindTexture(GL_TEXTURE_2D, id);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height,0, GL_RGBA,GL_UNSIGNED_BYTE, pixels);
+        loaded(static_cast<std::size_t>(width) * height * 4);
+        return true;
+    }
+    return false;
+}
+
+void Texture::doUnload() {
     if(id){
         glDeleteTextures(1, &id);
         id=0;
+    }
+}
+
+bool Texture::unload() {
+    if(id){
+        doUnload();
+        unloaded();
         return true;
     }else{
         return false;
     }
 }
 
+bool Texture::bind() const {
+    if(use()){
+        glBindTexture(GL_TEXTURE_2D, id);
+        return true;
+    }else if(loader_ && !failed()){
+        loader_->bindPlaceholder();
+        return false;
+    }else{
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return false;
+    }
+}
+
+TextureLoader::TextureLoader(Core::ThreadPool &pool, Core::Path cacheFolder) : pool_(pool), cache_(cacheFolder), results_(new Results{}), requested_(), nextRequest_(), placeholder_(){
+}
+
+TextureLoader::~TextureLoader(){
+    if(placeholder_){
+        glDeleteTextures(1, &placeholder_);
+    }
+}
+
+void TextureLoader::request(Texture *texture){
+    if(requested_.find(texture) == requested_.end()){
+        std::uint64_t request = nextRequest_++;
+        requested_[texture] = request;
+        // the task only touches the shared results, the texture may be gone when it runs
+        std::shared_ptr<Results> results{results_};
+        Core::Path file{texture->file()};
+        TexelCache cache{cache_};
+        pool_.submit([results, cache, texture, request, file](){
+            Decoded decoded{texture, request, TexelImage{}, false};
+            decoded.success = cache.load(file, decoded.image);
+            std::lock_guard<std::mutex> lock{results->mutex};
+            results->decoded.push_back(std::move(decoded));
+        });
+    }
+}
+
+void TextureLoader::cancel(Texture *texture){
+    requested_.erase(texture);
+}
 
+std::size_t TextureLoader::upload(){
+    std::vector<Decoded> decoded;
+    {
+        std::lock_guard<std::mutex> lock{results_->mutex};
+        decoded.swap(results_->decoded);
+    }
+    std::size_t uploaded = 0;
+    for(Decoded &result : decoded){
+        auto found = requested_.find(result.texture);
+        if(found != requested_.end() && found->second == result.request){
+            requested_.erase(found);
+            if(result.success && result.texture->upload(result.image.width(), result.image.height(), result.image.pixels())){
+                ++uploaded;
+            }else{
+                result.texture->failed(true);
+                std::cout << "unable to load texture from path '" << result.texture->file() << "'" << std::endl;
+            }
+        }
+    }
+    return uploaded;
+}
+
+void TextureLoader::bindPlaceholder(){
+    if(!placeholder_){
+        const GLubyte pixels[] = {96, 96, 96, 255, 64, 64, 64, 255, 64, 64, 64, 255, 96, 96, 96, 255};
+        glGenTextures(1, &placeholder_);
+        glBindTexture(GL_TEXTURE_2D, placeholder_);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 2, 2, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    }else{
+        glBindTexture(GL_TEXTURE_2D, placeholder_);
+    }
+}
+
+std::size_t TextureLoader::pending() const{
+    return requested_.size();
+}
+
+const TexelCache &TextureLoader::cache() const{
+    return cache_;
+}
+
+void TextureLoader::prune(){
+    TexelCache cache{cache_};
+    pool_.submit([cache](){
+        std::size_t removed = cache.prune();
+        if(removed){
+            std::cout << "removed " << removed << " stale texel cache entries" << std::endl;
+        }
+    });
+}
@@ -13,10 +13,25 @@
 #include "GL/gl.h"
 
 #include "Path.h"
+#include "ResourceCache.h"
+#include "ThreadPool.h"
+#include "TexelCache.h"
+
+#include <map>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstdint>
 
 namespace Game{
     
-    class Texture{
+    class TextureLoader;
+    
+    /*
+     * Only the GL texture is kept, the image is read from its file again after
+     * the texture was evicted from its cache
+     */
+    class Texture : public Core::CachedResource{
     public:
         GLuint id;
         
@@ -28,19 +43,112 @@ namespace Game{
 
         bool load(Core::Path file);
         
+        /*
+         * Remembers the file without reading it, the image is loaded on first use
+         */
+        void assign(Core::Path file);
+        
         bool unload();
         
+        /*
+         * Binds the texture, or the loader's placeholder while it is being decoded
+         */
+        bool bind() const;
+        
+        const Core::Path &file() const;
+        
+        using Core::CachedResource::attach;
+        
+        /*
+         * Decodes the image on the loader's workers instead of the using thread
+         */
+        void attach(TextureLoader *loader);
+        
         operator bool() const;
         
         bool operator!() const;
         
+    protected:
+        
+        bool doLoad();
+        
+        void doUnload();
+        
     private:
-        sf::Image image_;
+        Core::Path file_;
+        TextureLoader *loader_;
+        
+        bool upload(unsigned width, unsigned height, const void *pixels);
+        
+        /*
+         * The loader's cache, or the global one without a loader
+         */
+        const TexelCache &cache() const;
+        
+        friend class TextureLoader;
         
         Texture(const Texture &) = delete;
         Texture &operator=(const Texture &) = delete;
     };
     
+    /*
+     * Decodes texture images on a thread pool. The decoded images are uploaded
+     * by upload() on the thread owning the GL context, which also is the only
+     * thread requesting textures. Decoded images are kept in a texel cache
+     * so later runs map them instead of decoding again.
+     */
+    class TextureLoader{
+    public:
+        TextureLoader(Core::ThreadPool &pool, Core::Path cacheFolder);
+        
+        ~TextureLoader();
+        
+        void request(Texture *texture);
+        
+        void cancel(Texture *texture);
+        
+        /*
+         * Uploads the images decoded since the last call, returns their number
+         */
+        std::size_t upload();
+        
+        void bindPlaceholder();
+        
+        std::size_t pending() const;
+        
+        const TexelCache &cache() const;
+        
+        /*
+         * Removes unusable cache entries on the pool, once the sources'
+         * packs are mounted
+         */
+        void prune();
+        
+    private:
+        
+        struct Decoded{
+            Texture *texture;
+            std::uint64_t request;
+            TexelImage image;
+            bool success;
+        };
+        
+        struct Results{
+            std::mutex mutex;
+            std::vector<Decoded> decoded;
+        };
+        
+        Core::ThreadPool &pool_;
+        TexelCache cache_;
+        std::shared_ptr<Results> results_;
+        std::map<const Texture *, std::uint64_t> requested_;
+        std::uint64_t nextRequest_;
+        GLuint placeholder_;
+        
+        TextureLoader(const TextureLoader &) = delete;
+        TextureLoader &operator=(const TextureLoader &) = delete;
+    };
+    
 }
 
 #endif	/* TEXTURE_H */